@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) preg-v8-binder <https://github.com/pregusia/preg-v8-binder>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+
+
+
+// Copy count check for argument marshalling - heavy arguments are converted once and then
+// moved or bound by reference all the way to the callee, in both directions. Exits with 0 on success.
+
+#include <v8.h>
+#include <vector>
+#include <cstdint>
+
+// copies are counted, moves are not
+struct Payload {
+	static int32_t copies;
+
+	std::vector<int32_t> items;
+
+	Payload() { }
+	Payload(const Payload& o) : items(o.items) { copies += 1; }
+	Payload(Payload&& o) : items(std::move(o.items)) { }
+	Payload& operator=(const Payload& o) { items = o.items; copies += 1; return *this; }
+	Payload& operator=(Payload&& o) { items = std::move(o.items); return *this; }
+};
+
+int32_t Payload::copies = 0;
+
+namespace scripting {
+	class Engine;
+	namespace converters {
+		v8::Local<v8::Value> convertTo(Engine* engine, const Payload& v);
+		void convertFrom(Engine* engine, v8::Local<v8::Value> v, Payload& out);
+	}
+}
+
+#include <scripting/base.h>
+#include <scripting/object.h>
+#include <cstdio>
+
+namespace scripting { namespace converters {
+
+	v8::Local<v8::Value> convertTo(Engine* engine, const Payload& v) { return convertTo(engine, v.items); }
+	void convertFrom(Engine* engine, v8::Local<v8::Value> v, Payload& out) { convertFrom(engine, v, out.items); }
+
+} }
+
+class Sink: public scripting::ScriptableObject {
+	public:
+		static int32_t received;
+
+		static stdext::object_ptr<Sink> scriptingCtor(Payload p) { received += p.items.size(); return new Sink(); }
+
+		void byValue(Payload p) { received += p.items.size(); }
+		void byRef(const Payload& p) { received += p.items.size(); }
+};
+
+int32_t Sink::received = 0;
+
+static bool check(bool cond, const char* what) {
+	printf("%s: %s\n", cond ? "ok" : "FAILED", what);
+	return cond;
+}
+
+int main() {
+	g_engineScripting = new scripting::Engine;
+	g_engineScripting->registerNativeClass<Sink>("testing");
+	g_engineScripting->registerNativeClassMemberFunction<Sink>("byValue", &Sink::byValue);
+	g_engineScripting->registerNativeClassMemberFunction<Sink>("byRef", &Sink::byRef);
+	g_engineScripting->registerGlobalStaticFunction("globalByValue", [](Payload p) { Sink::received += p.items.size(); });
+	g_engineScripting->registerGlobalStaticFunction("echo", [](Payload p) { return p; });
+
+	bool res = true;
+
+	// script -> native
+	g_engineScripting->runString("copy_count.js",
+		"var p = [1, 2, 3];"
+		"var s = new testing.Sink(p);"
+		"s.byValue(p); s.byRef(p); globalByValue(p);"
+		"var back = echo(p);"
+	);
+	res &= check(Sink::received == 12, "arguments delivered");
+	res &= check(Payload::copies == 0, "no copies from script to native");
+
+	// native -> script
+	Payload payload;
+	payload.items.assign(1000, 7);
+
+	auto byRef = g_engineScripting->compileFunction<int32_t, const Payload&>("copy_count.js", "function(p) { return p.length; }");
+	auto byValue = g_engineScripting->compileFunction<int32_t, Payload>("copy_count.js", "function(p) { return p.length; }");
+	res &= check(byRef(payload) == 1000, "by reference call delivered");
+	res &= check(byValue(std::move(payload)) == 1000, "by value call delivered");
+	res &= check(Payload::copies == 0, "no copies from native to script");
+
+	delete g_engineScripting;
+	g_engineScripting = nullptr;
+	return res ? 0 : 1;
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) preg-v8-binder <https://github.com/pregusia/preg-v8-binder>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+
+
+
+// Overload selection check for registerNativeClassMemberFunction with several signatures.
+// Exits with 0 on success.
+
+#include <scripting/base.h>
+#include <scripting/object.h>
+#include <cstdio>
+
+class Picker: public scripting::ScriptableObject {
+	public:
+		static stdext::object_ptr<Picker> scriptingCtor() { return new Picker(); }
+
+		std::string pickInt(int32_t a) { return "int"; }
+		std::string pickString(const std::string& s) const { return "string"; }
+		std::string pickPair(int32_t a, int32_t b) { return "pair"; }
+};
+
+static bool check(const std::string& got, const std::string& expected, const char* what) {
+	bool res = got == expected;
+	printf("%s: %s (%s)\n", res ? "ok" : "FAILED", what, got.c_str());
+	return res;
+}
+
+int main() {
+	g_engineScripting = new scripting::Engine;
+	g_engineScripting->registerNativeClass<Picker>("testing");
+	g_engineScripting->registerNativeClassMemberFunction<Picker>("pick",
+		&Picker::pickInt,
+		&Picker::pickString,
+		&Picker::pickPair,
+		[](Picker* p, scripting::ReturnSlot ret, const std::string& s, scripting::ArgsView rest) { ret.set(std::string("variadic")); }
+	);
+
+	auto pick = g_engineScripting->compileFunction<std::string, std::string>("overloads.js",
+		"function(args) { var p = new testing.Picker(); return p.pick.apply(p, JSON.parse(args)); }"
+	);
+
+	bool res = true;
+	res &= check(pick("[1]"), "int", "exact arity, type decides");
+	res &= check(pick("[1.5]"), "int", "number converts to int");
+	res &= check(pick("[\"a\"]"), "string", "string argument");
+	res &= check(pick("[1, 2]"), "pair", "two arguments");
+	res &= check(pick("[\"a\", 1, 2]"), "variadic", "variadic when no fixed arity fits");
+	res &= check(pick("[1, 2, 3]"), "pair", "extra arguments ignored by largest arity below");
+
+	delete g_engineScripting;
+	g_engineScripting = nullptr;
+	return res ? 0 : 1;
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) preg-v8-binder <https://github.com/pregusia/preg-v8-binder>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+
+
+// Leak check for WrapperLifetime::TRACED - native object keeps JS state through TracedHandle,
+// JS state references wrapper of the native object back. Cycle has to survive while script
+// holds it and be reclaimed once it does not. Exits with 0 on success.
+
+#include <scripting/base.h>
+#include <scripting/object.h>
+#include <cstdio>
+
+class TracedNode: public scripting::ScriptableObject {
+	public:
+		static int32_t live;
+
+		TracedNode() { live += 1; }
+		virtual ~TracedNode() { live -= 1; }
+
+		static stdext::object_ptr<TracedNode> scriptingCtor() { return new TracedNode(); }
+
+		scripting::WrapperLifetime scriptingLifetime() const override { return scripting::WrapperLifetime::TRACED; }
+		void scriptingTraceReferences(scripting::ReferenceTracer& tracer) override { tracer.trace(m_state); }
+
+		void setState(v8::Local<v8::Object> state) { m_state.reset(g_engineScripting->isolate(), state); }
+		bool hasState() const { return !m_state.empty(); }
+
+	private:
+		scripting::TracedHandle<v8::Object> m_state;
+};
+
+int32_t TracedNode::live = 0;
+
+static bool check(bool cond, const char* what) {
+	printf("%s: %s\n", cond ? "ok" : "FAILED", what);
+	return cond;
+}
+
+int main() {
+	g_engineScripting = new scripting::Engine;
+	g_engineScripting->registerNativeClass<TracedNode>("testing");
+	g_engineScripting->registerNativeClassMemberFunction<TracedNode>("setState", &TracedNode::setState);
+	g_engineScripting->registerNativeClassMemberFunction<TracedNode>("hasState", &TracedNode::hasState);
+
+	bool res = true;
+
+	// node -> (traced) state -> node wrapper
+	g_engineScripting->runString("traced_cycle.js",
+		"var nodes = [];"
+		"for (var i = 0; i < 100; ++i) { var n = new testing.TracedNode(); n.setState({ owner: n, payload: new Array(1000) }); nodes.push(n); }"
+	);
+	res &= check(TracedNode::live == 100, "nodes created");
+
+	// reachable cycle - neither side may be collected
+	g_engineScripting->gc();
+	g_engineScripting->gc();
+	res &= check(TracedNode::live == 100, "reachable nodes kept");
+	res &= check(g_engineScripting->compileFunction<bool>("traced_cycle.js", "function() { return nodes.every(function(n) { return n.hasState(); }); }")(), "traced state kept while owner is alive");
+
+	// unreachable cycle - whole cycle goes away
+	g_engineScripting->runString("traced_cycle.js", "nodes = null; n = null;");
+	for(int32_t i=0;i<4 && TracedNode::live > 0;++i) g_engineScripting->gc();
+	res &= check(TracedNode::live == 0, "unreachable cycle reclaimed");
+
+	delete g_engineScripting;
+	g_engineScripting = nullptr;
+	return res ? 0 : 1;
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) preg-v8-binder <https://github.com/pregusia/preg-v8-binder>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "arena.h"
+
+namespace scripting { namespace internal {
+
+	const std::size_t BindingArena::CHUNK_SIZE;
+
+	// ************************************************************************************
+	BindingArena::BindingArena() : m_cursor(nullptr), m_end(nullptr), m_reserved(0), m_used(0) {
+
+	}
+
+	// ************************************************************************************
+	BindingArena::~BindingArena() {
+		for(auto chunk: m_chunks) delete[] chunk;
+		m_chunks.clear();
+	}
+
+	// ************************************************************************************
+	std::size_t BindingArena::alignSize(std::size_t size) {
+		const std::size_t align = alignof(std::max_align_t);
+		if (size < sizeof(FreeRecord)) size = sizeof(FreeRecord);
+		return (size + align - 1) & ~(align - 1);
+	}
+
+	// ************************************************************************************
+	void* BindingArena::allocate(std::size_t size) {
+		size = alignSize(size);
+
+		for(auto& it: m_free) {
+			if (it.first == size && it.second != nullptr) {
+				FreeRecord* rec = it.second;
+				it.second = rec->next;
+				m_used += size;
+				return rec;
+			}
+		}
+
+		if (m_cursor == nullptr || (std::size_t)(m_end - m_cursor) < size) {
+			std::size_t chunkSize = std::max(CHUNK_SIZE, size);
+			// operator new[] memory is aligned for any fundamental type
+			char* chunk = new char[chunkSize];
+			m_chunks.push_back(chunk);
+			m_cursor = chunk;
+			m_end = chunk + chunkSize;
+			m_reserved += chunkSize;
+		}
+
+		void* p = m_cursor;
+		m_cursor += size;
+		m_used += size;
+		return p;
+	}
+
+	// ************************************************************************************
+	void BindingArena::release(void* p, std::size_t size) {
+		if (p == nullptr) return;
+		size = alignSize(size);
+		m_used -= size;
+
+		FreeRecord* rec = static_cast<FreeRecord*>(p);
+		for(auto& it: m_free) {
+			if (it.first == size) {
+				rec->next = it.second;
+				it.second = rec;
+				return;
+			}
+		}
+		rec->next = nullptr;
+		m_free.push_back(std::make_pair(size, rec));
+	}
+
+	// ************************************************************************************
+	const std::string* BindingArena::intern(const std::string& s) {
+		return &*m_names.insert(s).first;
+	}
+
+	// ************************************************************************************
+	const std::string* BindingArena::lookup(const std::string& s) const {
+		auto it = m_names.find(s);
+		return (it != m_names.end()) ? &*it : nullptr;
+	}
+
+} } /* namespace scripting::internal */
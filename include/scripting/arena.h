@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) preg-v8-binder <https://github.com/pregusia/preg-v8-binder>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+
+
+#ifndef INCLUDE_SCRIPTING_ARENA_H_
+#define INCLUDE_SCRIPTING_ARENA_H_
+
+#include "base.h"
+#include <new>
+#include <unordered_set>
+#include <utility>
+
+namespace scripting { namespace internal {
+
+	// Per-engine storage of binding metadata (prototypes, function holders, names). Records are
+	// carved from large chunks, released records of same size are reused; everything is freed
+	// at once with engine, destructors of records still alive then are not run.
+	class BindingArena {
+		public:
+			BindingArena();
+			~BindingArena();
+
+			void* allocate(std::size_t size);
+			void release(void* p, std::size_t size);
+
+			template<typename T, typename... Args>
+			T* create(Args&&... args) {
+				void* p = allocate(sizeof(T));
+				try {
+					return new (p) T(std::forward<Args>(args)...);
+				} catch (...) {
+					release(p, sizeof(T));
+					throw;
+				}
+			}
+
+			template<typename T>
+			void destroy(T* p) {
+				if (p == nullptr) return;
+				p->~T();
+				release(p, sizeof(T));
+			}
+
+			// same text always gives same pointer, so interned names are compared by pointer
+			const std::string* intern(const std::string& s);
+			// nullptr when text was never interned
+			const std::string* lookup(const std::string& s) const;
+
+			std::size_t reservedBytes() const { return m_reserved; }
+			std::size_t usedBytes() const { return m_used; }
+			std::size_t internedCount() const { return m_names.size(); }
+
+		private:
+			struct FreeRecord {
+				FreeRecord* next;
+			};
+
+			std::vector<char*> m_chunks;
+			char* m_cursor;
+			char* m_end;
+			std::size_t m_reserved;
+			std::size_t m_used;
+			std::vector<std::pair<std::size_t, FreeRecord*>> m_free;
+			std::unordered_set<std::string> m_names;
+
+			static const std::size_t CHUNK_SIZE = 16 * 1024;
+			static std::size_t alignSize(std::size_t size);
+	};
+
+} } /* namespace scripting::internal */
+
+#endif /* INCLUDE_SCRIPTING_ARENA_H_ */
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) preg-v8-binder <https://github.com/pregusia/preg-v8-binder>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef INCLUDE_SCRIPTING_ARGS_H_
+#define INCLUDE_SCRIPTING_ARGS_H_
+
+#include "base.h"
+#include "converters.h"
+#include <v8.h>
+
+namespace scripting {
+
+	class Engine;
+
+	// Writes result of native function directly into v8 return value slot.
+	// Primitive values are stored without creating handles.
+	class ReturnSlot {
+		public:
+			ReturnSlot() : m_engine(nullptr), m_info(nullptr) { }
+			ReturnSlot(Engine* engine, const v8::FunctionCallbackInfo<v8::Value>& info) : m_engine(engine), m_info(&info) { }
+
+			void set(bool v) { m_info->GetReturnValue().Set(v); }
+			void set(int32_t v) { m_info->GetReturnValue().Set(v); }
+			void set(uint32_t v) { m_info->GetReturnValue().Set(v); }
+			void set(float v) { m_info->GetReturnValue().Set((double)v); }
+			void set(double v) { m_info->GetReturnValue().Set(v); }
+
+			template<typename T>
+			void set(v8::Local<T> v) { m_info->GetReturnValue().Set(v); }
+
+			template<typename T>
+			void set(const T& v) { m_info->GetReturnValue().Set(converters::convertTo(m_engine, v)); }
+
+			void setNull() { m_info->GetReturnValue().SetNull(); }
+			void setUndefined() { m_info->GetReturnValue().SetUndefined(); }
+			void setEmptyString() { m_info->GetReturnValue().SetEmptyString(); }
+
+		private:
+			Engine* m_engine;
+			const v8::FunctionCallbackInfo<v8::Value>* m_info;
+	};
+
+	// Parameter type giving access to remaining call arguments (from its position on).
+	// Nothing is converted nor copied up front - values are converted on get<T>(i).
+	class ArgsView {
+		public:
+			ArgsView() : m_engine(nullptr), m_info(nullptr), m_offset(0) { }
+			ArgsView(Engine* engine, const v8::FunctionCallbackInfo<v8::Value>& info, int offset = 0) : m_engine(engine), m_info(&info), m_offset(offset) { }
+
+			Engine* engine() const { return m_engine; }
+			int length() const { return (m_info != nullptr && m_info->Length() > m_offset) ? m_info->Length() - m_offset : 0; }
+			bool empty() const { return length() == 0; }
+			bool has(int i) const { return i >= 0 && i < length(); }
+
+			// undefined when out of range
+			v8::Local<v8::Value> operator[](int i) const { return (*m_info)[m_offset + i]; }
+
+			bool isUndefined(int i) const { return !has(i) || (*this)[i]->IsUndefined(); }
+			bool isNull(int i) const { return has(i) && (*this)[i]->IsNull(); }
+			bool isBoolean(int i) const { return has(i) && (*this)[i]->IsBoolean(); }
+			bool isInt32(int i) const { return has(i) && (*this)[i]->IsInt32(); }
+			bool isNumber(int i) const { return has(i) && (*this)[i]->IsNumber(); }
+			bool isString(int i) const { return has(i) && (*this)[i]->IsString(); }
+			bool isObject(int i) const { return has(i) && (*this)[i]->IsObject(); }
+			bool isArray(int i) const { return has(i) && (*this)[i]->IsArray(); }
+			bool isFunction(int i) const { return has(i) && (*this)[i]->IsFunction(); }
+
+			template<typename T>
+			T get(int i) const {
+				if (!has(i)) return T();
+				return converters::ConverterHelper<T>::from(m_engine, (*this)[i]);
+			}
+
+			template<typename T>
+			T get(int i, const T& def) const {
+				if (!has(i)) return def;
+				return converters::ConverterHelper<T>::from(m_engine, (*this)[i]);
+			}
+
+			v8::Local<v8::Object> self() const { return m_info->This(); }
+			ReturnSlot returnSlot() const { return ReturnSlot(m_engine, *m_info); }
+
+		private:
+			Engine* m_engine;
+			const v8::FunctionCallbackInfo<v8::Value>* m_info;
+			int m_offset;
+	};
+
+} /* namespace scripting */
+
+#endif /* INCLUDE_SCRIPTING_ARGS_H_ */
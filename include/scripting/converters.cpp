@@ -31,12 +31,22 @@ namespace scripting { namespace converters {
 	void convertFrom(Engine* engine, v8::Local<v8::Value> v, bool& out) { out = v.IsEmpty() ? false : v->ToBoolean()->Value(); }
 
 	// ************************************************************************************
-	v8::Local<v8::Value> convertTo(Engine* engine, int64_t v) { return engine->newInt(v); }
-	void convertFrom(Engine* engine, v8::Local<v8::Value> v, int64_t& out) { out = v.IsEmpty() ? 0 : v->ToInt32()->Value(); }
+	v8::Local<v8::Value> convertTo(Engine* engine, int64_t v) {
+		if (v >= INT32_MIN && v <= INT32_MAX) return engine->newInt((int32_t)v);
+		return engine->newDouble((double)v);
+	}
+	void convertFrom(Engine* engine, v8::Local<v8::Value> v, int64_t& out) { out = v.IsEmpty() ? 0 : v->IntegerValue(engine->context()).FromMaybe(0); }
 
 	// ************************************************************************************
-	v8::Local<v8::Value> convertTo(Engine* engine, uint64_t v) { return engine->newInt(v); }
-	void convertFrom(Engine* engine, v8::Local<v8::Value> v, uint64_t& out) { out = v.IsEmpty() ? 0 : v->ToUint32()->Value(); }
+	v8::Local<v8::Value> convertTo(Engine* engine, uint64_t v) {
+		if (v <= INT32_MAX) return engine->newInt((int32_t)v);
+		return engine->newDouble((double)v);
+	}
+	void convertFrom(Engine* engine, v8::Local<v8::Value> v, uint64_t& out) {
+		// full range, as convertTo gives doubles above int32; negative, NaN and too large give 0
+		double d = v.IsEmpty() ? 0.0 : v->NumberValue(engine->context()).FromMaybe(0.0);
+		out = (d > 0.0 && d < 18446744073709551616.0) ? (uint64_t)d : 0;
+	}
 
 	// ************************************************************************************
 	v8::Local<v8::Value> convertTo(Engine* engine, uint32_t v) { return engine->newInt(v); }
@@ -27,10 +27,29 @@
 #include "base.h"
 #include <v8.h>
 
-namespace scripting { class Engine; }
+namespace scripting {
+	class Engine;
+	template<typename T> class StructDescriptor;
+	template<typename C> class view;
+}
 
 namespace scripting { namespace converters {
 
+	// structs declaring their fields by static method:
+	//   static void scriptingStruct(scripting::StructDescriptor<T>& d)
+	template<typename T>
+	struct is_reflected_struct {
+		template<typename, typename> struct checker { };
+
+		template<typename C>
+		static std::true_type test(checker<C, decltype(&C::scriptingStruct)> *);
+
+		template<typename C>
+		static std::false_type test(...);
+
+		static const bool value = std::is_same<std::true_type, decltype(test<T>(nullptr))>::value;
+	};
+
 	v8::Local<v8::Value> convertTo(Engine* engine, bool v);
 	void convertFrom(Engine* engine, v8::Local<v8::Value> v, bool& out);
 
@@ -81,6 +100,12 @@ namespace scripting { namespace converters {
 	template<typename T>
 	void convertFrom(Engine* engine, v8::Local<v8::Value> v, stdext::object_ptr<T>& out);
 
+	template<typename T>
+	v8::Local<v8::Value> convertTo(Engine* engine, const stdext::weak_object_ptr<T>& v);
+
+	template<typename T>
+	void convertFrom(Engine* engine, v8::Local<v8::Value> v, stdext::weak_object_ptr<T>& out);
+
 	template<typename T>
 	v8::Local<v8::Value> convertTo(Engine* engine, const std::vector<T>& v);
 	template<typename T>
@@ -88,15 +113,31 @@ namespace scripting { namespace converters {
 
 	template<typename T>
 	v8::Local<v8::Value> convertTo(Engine* engine, const std::list<T>& v);
+	template<typename T>
+	void convertFrom(Engine* engine, v8::Local<v8::Value> v, std::list<T>& out);
 
 	template<typename T>
 	v8::Local<v8::Value> convertTo(Engine* engine, const std::deque<T>& v);
-
 	template<typename T>
-	v8::Local<v8::Value> convertTo(Engine* engine, const std::map<int, T>& v);
+	void convertFrom(Engine* engine, v8::Local<v8::Value> v, std::deque<T>& out);
 
 	template<typename T>
-	v8::Local<v8::Value> convertTo(Engine* engine, const std::map<std::string, T>& v);
+	v8::Local<v8::Value> convertTo(Engine* engine, const std::set<T>& v);
+	template<typename T>
+	void convertFrom(Engine* engine, v8::Local<v8::Value> v, std::set<T>& out);
+
+	template<typename K, typename V>
+	v8::Local<v8::Value> convertTo(Engine* engine, const std::map<K, V>& v);
+	template<typename K, typename V>
+	void convertFrom(Engine* engine, v8::Local<v8::Value> v, std::map<K, V>& out);
+
+	template<typename K, typename V>
+	v8::Local<v8::Value> convertTo(Engine* engine, const std::unordered_map<K, V>& v);
+	template<typename K, typename V>
+	void convertFrom(Engine* engine, v8::Local<v8::Value> v, std::unordered_map<K, V>& out);
+
+	template<typename C>
+	v8::Local<v8::Value> convertTo(Engine* engine, const view<C>& v);
 
 	template<typename R, typename... Args>
 	v8::Local<v8::Value> convertTo(Engine* engine, const std::function<R(Args...)>& f);
@@ -110,6 +151,12 @@ namespace scripting { namespace converters {
 	template<typename T,class=typename std::enable_if<std::is_enum<T>::value>::type>
 	void convertFrom(Engine* engine, v8::Local<v8::Value> v, T& out);
 
+	template<typename T>
+	typename std::enable_if<is_reflected_struct<T>::value, v8::Local<v8::Value>>::type convertTo(Engine* engine, const T& v);
+
+	template<typename T>
+	typename std::enable_if<is_reflected_struct<T>::value>::type convertFrom(Engine* engine, v8::Local<v8::Value> v, T& out);
+
 	template<typename T>
 	struct ConverterHelper {
 		static T from(Engine* engine, v8::Local<v8::Value> v) {
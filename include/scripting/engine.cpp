@@ -45,25 +45,137 @@ namespace scripting {
 
 
 
+	namespace internal {
+		// handles are registered in engine registry - engine resets them at shutdown, handles of
+		// exceptions dropped before are reset on next safe point (exception can be dropped outside any scope)
+		class ScriptExceptionState {
+			public:
+				Engine* engine;
+				std::shared_ptr<functions::FunctionCallerRegistry> registry;
+				v8::Global<v8::Message> message;
+				v8::Global<v8::Value> exception;
+				std::string text;
+				bool formatted;
+
+				ScriptExceptionState(Engine* engine) : engine(engine), registry(engine->m_functionCallers), formatted(false) {
+					std::lock_guard<std::mutex> lock(registry->mutex);
+					registry->exceptions.insert(this);
+				}
+
+				~ScriptExceptionState() {
+					std::lock_guard<std::mutex> lock(registry->mutex);
+					registry->exceptions.erase(this);
+					if (!registry->alive) return;
+					if (!message.IsEmpty()) registry->releasedMessages.push_back(std::move(message));
+					if (!exception.IsEmpty()) registry->releasedValues.push_back(std::move(exception));
+				}
+
+				// engine lock has to be held
+				void format() {
+					ScriptingScope scope(engine);
+					v8::Local<v8::Context> context = engine->context();
+
+					std::stringstream ss;
+					ss << "ScriptingException occured" << std::endl;
+
+					v8::Local<v8::Message> msg = message.Get(engine->isolate());
+					if (!msg.IsEmpty()) {
+						ss << "Line: " << msg->GetLineNumber(context).FromMaybe(0) << std::endl;
+						ss << "File: " << converters::ConverterHelper<std::string>::from(engine, msg->GetScriptOrigin().ResourceName()) << std::endl;
+					}
+
+					// same as TryCatch::StackTrace - stack property of thrown object
+					v8::Local<v8::Value> ex = exception.Get(engine->isolate());
+					if (!ex.IsEmpty()) {
+						v8::Local<v8::Value> stack;
+						if (ex->IsObject() && v8::Local<v8::Object>::Cast(ex)->Get(context, engine->newString("stack")).ToLocal(&stack) && !stack->IsUndefined()) {
+							ss << converters::ConverterHelper<std::string>::from(engine, stack);
+						} else {
+							ss << converters::ConverterHelper<std::string>::from(engine, ex);
+						}
+					}
+					text = ss.str();
+
+					// not needed any more
+					message.Reset();
+					exception.Reset();
+				}
+		};
+	}
+
 	// ************************************************************************************
-	void ScriptingScope::checkThrowException(bool clear) {
-		if (m_tryCatch.HasCaught()) {
-			std::stringstream ss;
-			ss << "ScriptingException occured" << std::endl;
+	ScriptException::ScriptException(Engine* engine, v8::TryCatch& tryCatch) : ScriptingException(std::string()), m_state(std::make_shared<internal::ScriptExceptionState>(engine)) {
+		v8::Local<v8::Message> msg = tryCatch.Message();
+		if (!msg.IsEmpty()) m_state->message.Reset(engine->isolate(), msg);
+
+		v8::Local<v8::Value> exception = tryCatch.Exception();
+		if (!exception.IsEmpty()) m_state->exception.Reset(engine->isolate(), exception);
+	}
 
-			v8::Local<v8::Message> msg = m_tryCatch.Message();
-			if (!msg.IsEmpty()) {
-				ss << "Line: " << msg->GetLineNumber() << std::endl;
-				ss << "File: " << converters::ConverterHelper<std::string>::from(m_engine, msg->GetScriptOrigin().ResourceName()) << std::endl;
+	// ************************************************************************************
+	const char* ScriptException::what() const throw() {
+		if (!m_state->formatted) {
+			m_state->formatted = true;
+
+			bool alive = false;
+			if (true) {
+				std::lock_guard<std::mutex> lock(m_state->registry->mutex);
+				alive = m_state->registry->alive;
+			}
+
+			m_state->text = "ScriptingException occured";
+			if (alive) {
+				try {
+					m_state->format();
+				} catch(...) {
+					m_state->text = "ScriptingException occured";
+				}
 			}
+		}
+		return m_state->text.c_str();
+	}
 
-			ss << converters::ConverterHelper<std::string>::from(m_engine, m_tryCatch.StackTrace());
+	// ************************************************************************************
+	bool ScriptingScope::isEntered(Engine* e) {
+		v8::Isolate* isolate = e->m_isolate;
+		if (e->m_threadingMode == Engine::ThreadingMode::OWNER) {
+			assert(std::this_thread::get_id() == e->m_ownerThread && "engine used outside of its owner thread");
+		} else {
+			if (!v8::Locker::IsLocked(isolate)) return false;
+		}
+		if (v8::Isolate::GetCurrent() != isolate) return false;
+		if (!isolate->InContext()) return false;
+
+		// own HandleScope - scope's m_handleScope does not exist yet and caller's one would grow
+		v8::HandleScope handleScope(isolate);
+		return isolate->GetCurrentContext() == e->m_context;
+	}
+
+	// ************************************************************************************
+	void ScriptingScope::enter() {
+		if (!m_nested) m_engine->processDeferred();
+	}
+
+	// ************************************************************************************
+	ScriptingScope::~ScriptingScope() {
+		// end of outermost scope is safe point for deferred finalization - engine is still
+		// locked and entered, and no native frame below uses released objects
+		if (!m_nested) {
+			m_engine->processDeferred();
+			if (m_engine->m_finalizationQueue != nullptr) m_engine->m_finalizationQueue->safePoint();
+		}
+	}
+
+	// ************************************************************************************
+	void ScriptingScope::checkThrowException(bool clear) {
+		if (m_tryCatch.HasCaught()) {
+			ScriptException ex(m_engine, m_tryCatch);
 
 			if (clear) {
 				m_tryCatch.Reset();
 			}
 
-			throw ScriptingException(ss.str());
+			throw ex;
 		}
 	}
 
@@ -79,7 +191,7 @@ namespace scripting {
 
 
 	// ************************************************************************************
-	Engine::Engine() {
+	Engine::Engine(ThreadingMode threadingMode) : m_threadingMode(threadingMode), m_ownerThread(std::this_thread::get_id()) {
 		v8::V8::InitializeICU();
 
 		m_platform = v8::platform::CreateDefaultPlatform();
@@ -91,7 +203,22 @@ namespace scripting {
 
 		m_isolate = v8::Isolate::New(isolateCreateParams);
 		m_isolate->SetData(0, this);
+		m_bindingArena = new internal::BindingArena();
 		m_suppressCtorCallback = false;
+		m_viewSupport = nullptr;
+		m_methodCacheGeneration = 0;
+		m_eventCallName = nullptr;
+		m_eventCallReturnName = nullptr;
+		m_externalMemory = ExternalMemoryStats();
+		m_gcPolicy = new GcPolicy(this);
+		m_finalizationQueue = new FinalizationQueue();
+		m_heapTracer = new internal::HeapTracer(this);
+		m_peakUsedHeap = 0;
+		m_peakObjects = 0;
+		m_peakFunctions = 0;
+		m_peakExternalMemory = 0;
+		m_lifetimeChangesQueued = false;
+		m_functionCallers = std::make_shared<functions::FunctionCallerRegistry>();
 
 		if (true) {
 			v8::Isolate::Scope isolateScope(m_isolate);
@@ -114,6 +241,10 @@ namespace scripting {
 
 			registerNativeClassMemberFunction<ScriptableObject>("eventRegister", &ScriptableObject::eventRegister);
 			registerNativeClassMemberFunction<ScriptableObject>("eventUnregister", &ScriptableObject::eventUnregister);
+
+			registerNativeClass<WeakReference>("");
+			registerNativeClassMemberFunction<WeakReference>("get", &WeakReference::get);
+			registerNativeClassMemberFunction<WeakReference>("expired", &WeakReference::expired);
 		}
 
 		if (true) {
@@ -124,12 +255,62 @@ namespace scripting {
 		if (true) {
 			ScriptingScope scope(this);
 			NativeFunctions::RegisterObjectsFunctions(this);
+
+			registerNativeSingleton("ScriptingStats", this)
+				.method("get", &Engine::stats)
+				.method("resetPeaks", &Engine::resetPeaks)
+				.install();
 		}
 	}
 
 	// ************************************************************************************
 	Engine::~Engine() {
+		// queued destructors may still use engine
+		m_finalizationQueue->drainAll();
+
+		for(auto& st: m_structs) delete st;
+		m_structs.clear();
+		delete m_viewSupport;
+		m_viewSupport = nullptr;
+		for(auto& holder: m_accessors) delete holder;
+		m_accessors.clear();
+		for(auto& it: m_methodCache) delete it.second;
+		m_methodCache.clear();
+		for(auto& it: m_methodNames) delete it.second;
+		m_methodNames.clear();
+		if (true) {
+			// callers living on in natives see dead registry and empty handle
+			std::lock_guard<std::mutex> lock(m_functionCallers->mutex);
+			m_functionCallers->alive = false;
+			for(auto& it: m_functionCallers->callers) {
+				it.second->func.Reset();
+				it.second->engine = nullptr;
+			}
+			m_functionCallers->callers.clear();
+			for(auto& state: m_functionCallers->exceptions) {
+				state->message.Reset();
+				state->exception.Reset();
+			}
+			m_functionCallers->exceptions.clear();
+			m_functionCallers->released.clear();
+			m_functionCallers->releasedValues.clear();
+			m_functionCallers->releasedMessages.clear();
+		}
+		delete m_gcPolicy;
+		m_gcPolicy = nullptr;
+		delete m_finalizationQueue;
+		m_finalizationQueue = nullptr;
+
+		m_isolate->SetEmbedderHeapTracer(nullptr);
 		m_isolate->Dispose();
+		delete m_heapTracer;
+		m_heapTracer = nullptr;
+		for(auto& proto: m_prototypes) m_bindingArena->destroy(proto);
+		m_prototypes.clear();
+		m_prototypesByName.clear();
+		m_prototypesByNativeName.clear();
+		delete m_bindingArena;
+		m_bindingArena = nullptr;
 		v8::V8::Dispose();
 		v8::V8::ShutdownPlatform();
 		delete m_platform;
@@ -137,6 +318,31 @@ namespace scripting {
 	}
 
 
+	// ************************************************************************************
+	std::string Engine::describeException(v8::TryCatch& tryCatch) {
+		return describeException(tryCatch.Exception(), tryCatch.Message());
+	}
+
+	// ************************************************************************************
+	std::string Engine::describeException(v8::Local<v8::Value> exception, v8::Local<v8::Message> msg) {
+		std::stringstream ss;
+		ss << "ScriptingException occured" << std::endl;
+
+		if (!msg.IsEmpty()) {
+			ss << "Line: " << msg->GetLineNumber() << std::endl;
+			ss << "File: " << converters::ConverterHelper<std::string>::from(this, msg->GetScriptOrigin().ResourceName()) << std::endl;
+		}
+
+		// same as TryCatch::StackTrace - stack property of thrown object
+		if (!exception.IsEmpty() && exception->IsObject()) {
+			v8::Local<v8::Value> stack;
+			if (v8::Local<v8::Object>::Cast(exception)->Get(context(), newString("stack")).ToLocal(&stack)) {
+				ss << converters::ConverterHelper<std::string>::from(this, stack);
+			}
+		}
+		return ss.str();
+	}
+
 	// ************************************************************************************
 	void Engine::throwException(const std::string& msg) {
 		m_isolate->ThrowException(newString(msg));
@@ -162,6 +368,11 @@ namespace scripting {
 		return v8::String::NewFromUtf8(m_isolate, v.c_str(), v8::NewStringType::kNormal).ToLocalChecked();
 	}
 
+	// ************************************************************************************
+	v8::Local<v8::String> Engine::newInternalizedString(const std::string& v) {
+		return v8::String::NewFromUtf8(m_isolate, v.c_str(), v8::NewStringType::kInternalized).ToLocalChecked();
+	}
+
 	// ************************************************************************************
 	v8::Local<v8::Integer> Engine::newInt(int32_t v) {
 		return v8::Int32::New(m_isolate, v);
@@ -198,6 +409,21 @@ namespace scripting {
 		return arr;
 	}
 
+	// ************************************************************************************
+	v8::Local<v8::Array> Engine::newArray(v8::Local<v8::Value>* values, std::size_t n) {
+#if V8_MAJOR_VERSION > 7 || (V8_MAJOR_VERSION == 7 && V8_MINOR_VERSION >= 4)
+		return v8::Array::New(m_isolate, values, n);
+#else
+		// no Array::New(elements) in older V8 - appending from index 0 keeps array packed
+		v8::Local<v8::Array> arr = v8::Array::New(m_isolate, 0);
+		v8::Local<v8::Context> ctx = context();
+		for(std::size_t i=0;i<n;++i) {
+			if (values[i].IsEmpty() || !arr->Set(ctx, (uint32_t)i, values[i]).FromMaybe(false)) break;
+		}
+		return arr;
+#endif
+	}
+
 	// ************************************************************************************
 	v8::Local<v8::External> Engine::newExternal(void* p) {
 		return v8::External::New(m_isolate, p);
@@ -247,22 +473,158 @@ namespace scripting {
 	}
 
 	// ************************************************************************************
-	v8::Local<v8::Function> Engine::newFunctionInternal(const std::string& name, const functions::ScriptFunctor& functor) {
-		auto holder = new functions::ScriptFunctorHolder(this, name, functor);
+	internal::MethodName* Engine::internMethodName(const std::string& name) {
+		auto it = m_methodNames.find(name);
+		if (it != m_methodNames.end()) return it->second;
+
+		internal::MethodName* mn = new internal::MethodName(name);
+		mn->key.Reset(m_isolate, newInternalizedString(name));
+		m_methodNames[name] = mn;
+		return mn;
+	}
+
+	// ************************************************************************************
+	v8::Local<v8::Value> Engine::findMethod(v8::Local<v8::Object> obj, internal::MethodName* name) {
+		if (obj.IsEmpty()) return v8::Local<v8::Value>();
+
+		v8::Local<v8::Context> ctx = context();
+		v8::Local<v8::String> key = name->key.Get(m_isolate);
+
+		// methods overriden on instance are not cached
+		if (obj->HasRealNamedProperty(ctx, key).FromMaybe(false)) {
+			v8::Local<v8::Value> val;
+			if (obj->Get(ctx, key).ToLocal(&val) && val->IsFunction()) return val;
+		}
+
+		v8::Local<v8::Value> protoVal = obj->GetPrototype();
+		if (protoVal.IsEmpty() || !protoVal->IsObject()) return v8::Local<v8::Value>();
+		v8::Local<v8::Object> proto = v8::Local<v8::Object>::Cast(protoVal);
+
+		// objects of same class share prototype, so last entry of name usually matches
+		internal::MethodCacheEntry* entry = name->last;
+		if (entry == nullptr || entry->proto != proto) {
+			entry = nullptr;
+
+			int hash = proto->GetIdentityHash();
+			auto range = m_methodCache.equal_range(hash);
+			for(auto it = range.first; it != range.second; ++it) {
+				if (it->second->name == name && it->second->proto == proto) {
+					entry = it->second;
+					break;
+				}
+			}
+
+			if (entry == nullptr) {
+				if (m_methodCache.size() >= METHOD_CACHE_SIZE) {
+					// entries of collected prototypes first, everything when still full
+					for(auto it = m_methodCache.begin(); it != m_methodCache.end(); ) {
+						if (it->second->proto.IsEmpty()) {
+							delete it->second;
+							it = m_methodCache.erase(it);
+						} else {
+							++it;
+						}
+					}
+					if (m_methodCache.size() >= METHOD_CACHE_SIZE) {
+						for(auto& it: m_methodCache) delete it.second;
+						m_methodCache.clear();
+					}
+				}
+
+				entry = new internal::MethodCacheEntry(name);
+				entry->proto.Reset(m_isolate, proto);
+				entry->proto.SetWeak();
+				entry->generation = m_methodCacheGeneration - 1;
+				entry->found = true;
+				m_methodCache.insert(std::make_pair(hash, entry));
+			}
+			name->last = entry;
+		}
+
+		if (entry->generation == m_methodCacheGeneration) {
+			if (!entry->found) return v8::Local<v8::Value>();
+			if (!entry->func.IsEmpty()) return entry->func.Get(m_isolate);
+		}
+
+		// interceptors are skipped as they were never cacheable
+		v8::Local<v8::Value> val;
+		if (proto->GetRealNamedProperty(ctx, key).ToLocal(&val) && val->IsFunction()) {
+			entry->func.Reset(m_isolate, v8::Local<v8::Function>::Cast(val));
+			entry->func.SetWeak();
+			entry->found = true;
+			entry->generation = m_methodCacheGeneration;
+			return val;
+		}
+
+		// negative entry - warned once until cache is invalidated
+		if (entry->found || entry->generation != m_methodCacheGeneration) {
+			utils::logWarning(stdext::format("Could not find function %s", name->name));
+		}
+		entry->func.Reset();
+		entry->found = false;
+		entry->generation = m_methodCacheGeneration;
+		return v8::Local<v8::Value>();
+	}
+
+	// ************************************************************************************
+	internal::MethodName* Engine::eventDispatcherName(bool returning) {
+		internal::MethodName*& name = returning ? m_eventCallReturnName : m_eventCallName;
+		if (name == nullptr) name = internMethodName(returning ? "eventCallStaticReturn" : "eventCallStatic");
+		return name;
+	}
+
+	// ************************************************************************************
+	functions::ScriptFunctionCallerPtr Engine::getFunctionCaller(v8::Local<v8::Value> f) {
+		if (f.IsEmpty() || !f->IsFunction()) return functions::ScriptFunctionCallerPtr(new functions::ScriptFunctionCaller(this, f));
+
+		v8::Local<v8::Function> func = v8::Local<v8::Function>::Cast(f);
+		int hash = func->GetIdentityHash();
+
+		std::lock_guard<std::mutex> lock(m_functionCallers->mutex);
+		auto range = m_functionCallers->callers.equal_range(hash);
+		for(auto it = range.first; it != range.second; ++it) {
+			// reference taken under mutex and only while caller still has one, so it cannot be
+			// released concurrently; object_ptr then adds its own and extra one is dropped
+			if (it->second->func == func && it->second->tryRef()) {
+				functions::ScriptFunctionCallerPtr res(it->second);
+				it->second->releaseRef();
+				return res;
+			}
+		}
+
+		// registry does not hold reference - caller unregisters itself when last std::function is gone
+		functions::ScriptFunctionCaller* caller = new functions::ScriptFunctionCaller(this, func);
+		caller->registry = m_functionCallers;
+		caller->identityHash = hash;
+		m_functionCallers->callers.insert(std::make_pair(hash, caller));
+		return functions::ScriptFunctionCallerPtr(caller);
+	}
+
+	// ************************************************************************************
+	v8::Local<v8::Function> Engine::newFunctionInternal(const std::string& name, const functions::ScriptFunctor& functor, bool internName) {
+		// registration names are shared; names given at run time are arbitrary and interned ones
+		// are never released, so those stay with holder
+		functions::ScriptFunctorHolder* holder = nullptr;
+		if (internName) {
+			holder = m_bindingArena->create<functions::ScriptFunctorHolder>(this, m_bindingArena->intern(name), functor);
+		} else {
+			holder = m_bindingArena->create<functions::ScriptFunctorHolder>(this, name, functor);
+		}
+		holder->externalSize = sizeof(functions::ScriptFunctorHolder) + (int64_t)holder->ownName.capacity();
 
 		auto callCallback = [=](const v8::FunctionCallbackInfo<v8::Value>& args){
 			v8::Local<v8::External> data = v8::Local<v8::External>::Cast(args.Data());
 			functions::ScriptFunctorHolder* holder = (functions::ScriptFunctorHolder*)data->Value();
-			//utils::logDebug(stdext::format("Calling native function %s", holder->name));
+			//utils::logDebug(stdext::format("Calling native function %s", *holder->name));
 			holder->call(args);
 		};
 
 		auto freeCallback = [=](const v8::WeakCallbackInfo<void>& data){
 			functions::ScriptFunctorHolder* holder = (functions::ScriptFunctorHolder*)data.GetParameter();
-			//utils::logDebug(stdext::format("Releasing native function %s", holder->name));
+			//utils::logDebug(stdext::format("Releasing native function %s", *holder->name));
 			holder->funcPersistent.Reset();
-			data.GetIsolate()->AdjustAmountOfExternalAllocatedMemory(-FUNCTION_OBJECT_SIZE);
-			delete holder;
+			holder->engine->externalMemoryReleased(ExternalMemoryKind::FUNCTION, holder->externalSize);
+			holder->engine->bindingArena().destroy(holder);
 		};
 
 		v8::Local<v8::Function> func = v8::Function::New(m_isolate, callCallback, newExternal(holder));
@@ -270,11 +632,29 @@ namespace scripting {
 
 		holder->funcPersistent.Reset(m_isolate, func);
 		holder->funcPersistent.SetWeak((void*)holder, freeCallback, v8::WeakCallbackType::kParameter);
-		m_isolate->AdjustAmountOfExternalAllocatedMemory(FUNCTION_OBJECT_SIZE);
+		externalMemoryAllocated(ExternalMemoryKind::FUNCTION, holder->externalSize);
 
 		return func;
 	}
 
+	// ************************************************************************************
+	void Engine::registerNativeAccessor(Prototype* prototype, const std::string& propName, v8::AccessorNameGetterCallback getter, v8::AccessorNameSetterCallback setter, functions::AccessorHolderBase* holder) {
+		m_accessors.push_back(holder);
+		invalidateMethodCache();
+
+		// prototype template is already instantiated, so accessor goes to live prototype object
+		v8::Local<v8::Function> func = prototype->GetTemplate()->GetFunction(context()).ToLocalChecked();
+		v8::Local<v8::Value> proto = func->Get(newString("prototype"));
+		if (proto.IsEmpty() || !proto->IsObject()) throw ScriptingException(stdext::format("Could not get prototype object of %s", prototype->prototypeName));
+
+		int attrs = v8::DontDelete;
+		if (setter == nullptr) attrs |= v8::ReadOnly;
+
+		v8::Local<v8::Object> protoObj = v8::Local<v8::Object>::Cast(proto);
+		bool res = protoObj->SetAccessor(context(), newInternalizedString(propName), getter, setter, newExternal(holder), v8::DEFAULT, (v8::PropertyAttribute)attrs).FromMaybe(false);
+		if (!res) throw ScriptingException(stdext::format("Could not register accessor %s.%s", prototype->prototypeName, propName));
+	}
+
 	// ************************************************************************************
 	void Engine::registerSingleton(const std::string& singletonName) {
 		ScriptingScope scope(this);
@@ -292,6 +672,65 @@ namespace scripting {
 		global->Set(newString(singletonName), obj);
 	}
 
+	// ************************************************************************************
+	void Engine::installNativeSingleton(const std::string& singletonName, void* inst, std::vector<functions::NativeSingletonEntry>& entries) {
+		// engine takes ownership of holders
+		for(auto& entry: entries) m_accessors.push_back(entry.holder);
+
+		ScriptingScope scope(this);
+		v8::Local<v8::Object> global = m_context.Get(m_isolate)->Global();
+		if (global->HasOwnProperty(newString(singletonName))) {
+			entries.clear();
+			throw ScriptingException(stdext::format("Singleton %s already registered", singletonName));
+		}
+
+		v8::Local<v8::FunctionTemplate> ctor = v8::FunctionTemplate::New(m_isolate);
+		ctor->SetClassName(newString(stdext::format("Singleton_%s", singletonName)));
+
+		v8::Local<v8::ObjectTemplate> tpl = ctor->InstanceTemplate();
+		tpl->SetInternalFieldCount(1);
+
+		// methods can be called only on singleton object itself
+		v8::Local<v8::Signature> signature = v8::Signature::New(m_isolate, ctor);
+
+		for(auto& entry: entries) {
+			v8::Local<v8::String> key = newInternalizedString(entry.name);
+			if (entry.method != nullptr) {
+				v8::Local<v8::FunctionTemplate> method = v8::FunctionTemplate::New(m_isolate, entry.method, newExternal(entry.holder), signature);
+				method->SetClassName(key);
+				tpl->Set(key, method, (v8::PropertyAttribute)(v8::ReadOnly | v8::DontDelete));
+			} else {
+				int attrs = v8::DontDelete;
+				if (entry.setter == nullptr) attrs |= v8::ReadOnly;
+				tpl->SetAccessor(key, entry.getter, entry.setter, newExternal(entry.holder), v8::DEFAULT, (v8::PropertyAttribute)attrs);
+			}
+		}
+		entries.clear();
+
+		v8::Local<v8::Object> obj;
+		if (!tpl->NewInstance(context()).ToLocal(&obj)) {
+			scope.checkThrowException();
+			throw ScriptingException(stdext::format("Could not create singleton %s", singletonName));
+		}
+		obj->SetAlignedPointerInInternalField(0, inst);
+		internal::SetObjectPropChain(this, global, singletonName, obj);
+	}
+
+	// ************************************************************************************
+	void Engine::installConstants(const std::string& ns, v8::Local<v8::ObjectTemplate> tpl) {
+		v8::Local<v8::Object> obj;
+		if (!tpl->NewInstance(context()).ToLocal(&obj)) throw ScriptingException(stdext::format("Could not create constants object %s", ns));
+
+		// frozen object with read-only data properties lets v8 treat them as constants
+		if (!obj->SetIntegrityLevel(context(), v8::IntegrityLevel::kFrozen).FromMaybe(false)) {
+			throw ScriptingException(stdext::format("Could not freeze constants object %s", ns));
+		}
+
+		if (!internal::SetObjectPropChain(this, getGlobalObject(), ns, obj)) {
+			throw ScriptingException(stdext::format("Could not register constants namespace %s", ns));
+		}
+	}
+
 	// ************************************************************************************
 	void Engine::registerPrototype(const std::string& prototypeName, const std::string& basePrototypeName, const stdext::demangled_name& nativeClassName, v8::FunctionCallback ctor) {
 		auto currProto = findPrototypeByName(prototypeName);
@@ -306,6 +745,7 @@ namespace scripting {
 		}
 
 		ScriptingScope scope(this);
+		invalidateMethodCache();
 		v8::Local<v8::FunctionTemplate> tpl = v8::FunctionTemplate::New(m_isolate);
 		if (baseProto != nullptr) tpl->Inherit(baseProto->GetTemplate());
 
@@ -315,21 +755,26 @@ namespace scripting {
 			tpl->SetClassName(newString(nativeClassName.full()));
 		}
 		tpl->PrototypeTemplate()->Set(newString("__className"),newString(nativeClassName.full()));
-		tpl->InstanceTemplate()->SetInternalFieldCount(4);
+		tpl->InstanceTemplate()->SetInternalFieldCount(internal::WRAPPER_FIELD_COUNT);
 
 		if (ctor != nullptr) {
 			tpl->SetCallHandler(ctor, newExternal(this));
 		}
 
-		currProto = new Prototype(this);
+		currProto = m_bindingArena->create<Prototype>(this);
+		currProto->index = m_prototypes.size();
 		currProto->ctor = ctor;
 		currProto->nativeClassName = nativeClassName;
 		currProto->prototypeName = prototypeName;
 		currProto->basePrototype = baseProto;
 		currProto->ctor = ctor;
+		currProto->nativeSize = (baseProto != nullptr) ? baseProto->nativeSize : sizeof(ScriptableObject);
 		currProto->tpl.Reset(m_isolate, tpl);
 
 		m_prototypes.push_back(currProto);
+		// first registered wins, same as linear search did
+		m_prototypesByName.emplace(m_bindingArena->intern(prototypeName), currProto);
+		m_prototypesByNativeName.emplace(m_bindingArena->intern(nativeClassName.full()), currProto);
 		v8::Local<v8::Object> global = m_context.Get(m_isolate)->Global();
 		v8::Local<v8::Function> func = tpl->GetFunction();
 		func->Set(newString("__protoName"), newString(prototypeName));
@@ -395,18 +840,20 @@ namespace scripting {
 
 	// ************************************************************************************
 	Engine::Prototype* Engine::findPrototypeByName(const std::string& name) {
-		for(auto& p: m_prototypes) {
-			if (p->prototypeName == name) return p;
-		}
-		return nullptr;
+		const std::string* key = m_bindingArena->lookup(name);
+		if (key == nullptr) return nullptr;
+
+		auto it = m_prototypesByName.find(key);
+		return (it != m_prototypesByName.end()) ? it->second : nullptr;
 	}
 
 	// ************************************************************************************
 	Engine::Prototype* Engine::findPrototypeByNativeClassName(const stdext::demangled_name& name) {
-		for(auto& p: m_prototypes) {
-			if (p->nativeClassName == name) return p;
-		}
-		return nullptr;
+		const std::string* key = m_bindingArena->lookup(name.full());
+		if (key == nullptr) return nullptr;
+
+		auto it = m_prototypesByNativeName.find(key);
+		return (it != m_prototypesByNativeName.end()) ? it->second : nullptr;
 	}
 
 	// ************************************************************************************
@@ -422,6 +869,7 @@ namespace scripting {
 	// ************************************************************************************
 	void Engine::runString(const std::string& s_origin, const std::string& s_content) {
 		ScriptingScope scope(this);
+		invalidateMethodCache();
 
 		v8::ScriptOrigin origin(newString(s_origin));
 		v8::Local<v8::Script> script;
@@ -442,6 +890,7 @@ namespace scripting {
 
 	// ************************************************************************************
 	v8::Local<v8::Function> Engine::compileFunctionRaw(const std::string& sOrigin, const std::string& func) {
+		invalidateMethodCache();
 		v8::ScriptOrigin origin(newString(sOrigin));
 		v8::Local<v8::Script> script;
 		v8::Local<v8::String> content = newString(stdext::format("(%s)",func));
@@ -463,6 +912,7 @@ namespace scripting {
 	// ************************************************************************************
 	void Engine::CallInObjectContext(v8::Local<v8::Object> obj, const std::string& sOrigin, const std::string& sCode) {
 		ScriptingScope scope(this);
+		invalidateMethodCache();
 
 		v8::ScriptOrigin origin(newString(sOrigin));
 		v8::Local<v8::Script> script;
@@ -480,13 +930,210 @@ namespace scripting {
 		scope.checkThrowException();
 	}
 
+	// ************************************************************************************
+	void Engine::externalMemoryAllocated(ExternalMemoryKind kind, int64_t bytes) {
+		if (kind == ExternalMemoryKind::OBJECT) {
+			m_externalMemory.objectsMemory += bytes;
+			m_externalMemory.objects += 1;
+			m_peakObjects = std::max(m_peakObjects, m_externalMemory.objects);
+		} else {
+			m_externalMemory.functionsMemory += bytes;
+			m_externalMemory.functions += 1;
+			m_peakFunctions = std::max(m_peakFunctions, m_externalMemory.functions);
+		}
+		m_peakExternalMemory = std::max(m_peakExternalMemory, m_externalMemory.objectsMemory + m_externalMemory.functionsMemory);
+
+		m_externalMemory.pending += bytes;
+		if (m_externalMemory.pending >= EXTERNAL_MEMORY_BATCH) flushExternalMemory();
+	}
+
+	// ************************************************************************************
+	void Engine::externalMemoryReleased(ExternalMemoryKind kind, int64_t bytes) {
+		if (kind == ExternalMemoryKind::OBJECT) {
+			m_externalMemory.objectsMemory -= bytes;
+			m_externalMemory.objects -= 1;
+		} else {
+			m_externalMemory.functionsMemory -= bytes;
+			m_externalMemory.functions -= 1;
+		}
+
+		m_externalMemory.pending -= bytes;
+		if (m_externalMemory.pending <= -EXTERNAL_MEMORY_BATCH) flushExternalMemory();
+	}
+
+	// ************************************************************************************
+	void Engine::flushExternalMemory() {
+		if (m_externalMemory.pending == 0) return;
+
+		m_isolate->AdjustAmountOfExternalAllocatedMemory(m_externalMemory.pending);
+		m_externalMemory.reported += m_externalMemory.pending;
+		m_externalMemory.pending = 0;
+	}
+
+	// ************************************************************************************
+	EngineStats Engine::stats() {
+		ScriptingScope scope(this);
+		EngineStats res;
+
+		v8::HeapStatistics heap;
+		m_isolate->GetHeapStatistics(&heap);
+		res.totalHeapSize = heap.total_heap_size();
+		res.usedHeapSize = heap.used_heap_size();
+		res.heapSizeLimit = heap.heap_size_limit();
+		res.totalPhysicalSize = heap.total_physical_size();
+		res.mallocedMemory = heap.malloced_memory();
+		res.peakMallocedMemory = heap.peak_malloced_memory();
+		m_peakUsedHeap = std::max(m_peakUsedHeap, res.usedHeapSize);
+
+		for(std::size_t i=0;i<m_isolate->NumberOfHeapSpaces();++i) {
+			v8::HeapSpaceStatistics space;
+			if (!m_isolate->GetHeapSpaceStatistics(&space, i)) continue;
+
+			HeapSpaceStats s;
+			s.name = space.space_name();
+			s.size = space.space_size();
+			s.used = space.space_used_size();
+			s.available = space.space_available_size();
+			s.physical = space.physical_space_size();
+			res.heapSpaces.push_back(s);
+		}
+
+#if V8_MAJOR_VERSION > 6 || (V8_MAJOR_VERSION == 6 && V8_MINOR_VERSION >= 1)
+		v8::HeapCodeStatistics code;
+		if (m_isolate->GetHeapCodeAndMetadataStatistics(&code)) {
+			res.codeAndMetadataSize = code.code_and_metadata_size();
+			res.bytecodeAndMetadataSize = code.bytecode_and_metadata_size();
+		}
+#else
+		// no code statistics in older V8 - code space usage only
+		for(auto& s: res.heapSpaces) {
+			if (s.name == "code_space") res.codeAndMetadataSize = s.used;
+		}
+#endif
+
+		for(auto& proto: m_prototypes) {
+			PrototypeStats s;
+			s.name = proto->prototypeName;
+			s.liveWrappers = proto->liveWrappers;
+			s.peakWrappers = proto->peakWrappers;
+			res.prototypes.push_back(s);
+		}
+
+		res.liveWrappers = m_externalMemory.objects;
+		res.functionHolders = m_externalMemory.functions;
+		res.externalMemory = m_externalMemory.objectsMemory + m_externalMemory.functionsMemory;
+		res.externalMemoryReported = m_externalMemory.reported;
+		res.pendingFinalizers = m_finalizationQueue->pending();
+
+		stdext::pool_stats pool = stdext::pool_get_stats();
+		res.poolAllocations = pool.allocations;
+		res.poolDeallocations = pool.deallocations;
+		res.poolLargeAllocations = pool.largeAllocations;
+		res.poolReservedBytes = pool.reservedBytes;
+
+		res.bindingArenaReserved = m_bindingArena->reservedBytes();
+		res.bindingArenaUsed = m_bindingArena->usedBytes();
+		res.internedNames = m_bindingArena->internedCount();
+
+		// persistent handles held by binder itself
+		res.persistentHandles = 1 + m_externalMemory.objects + m_externalMemory.functions + m_prototypes.size() + m_structs.size() + m_methodNames.size() + m_methodCache.size() * 2;
+		if (true) {
+			std::lock_guard<std::mutex> lock(m_functionCallers->mutex);
+			for(auto& it: m_functionCallers->callers) {
+				if (!it.second->func.IsEmpty()) res.persistentHandles += 1;
+			}
+			for(auto& state: m_functionCallers->exceptions) {
+				if (!state->message.IsEmpty()) res.persistentHandles += 1;
+				if (!state->exception.IsEmpty()) res.persistentHandles += 1;
+			}
+			res.persistentHandles += m_functionCallers->released.size() + m_functionCallers->releasedValues.size() + m_functionCallers->releasedMessages.size();
+		}
+
+		res.peakUsedHeapSize = m_peakUsedHeap;
+		res.peakLiveWrappers = m_peakObjects;
+		res.peakFunctionHolders = m_peakFunctions;
+		res.peakExternalMemory = m_peakExternalMemory;
+		return res;
+	}
+
+	// ************************************************************************************
+	bool Engine::holdsIsolate() const {
+		if (v8::Isolate::GetCurrent() != m_isolate) return false;
+		if (m_threadingMode == ThreadingMode::OWNER) return std::this_thread::get_id() == m_ownerThread;
+		return v8::Locker::IsLocked(m_isolate);
+	}
+
+	// ************************************************************************************
+	void Engine::queueLifetimeChange(ScriptableObject* obj) {
+		// isolate thread (native code storing object during JS->native callback) switches right
+		// away, GC later in the same scope would collect wrapper otherwise
+		if (holdsIsolate()) {
+			obj->scriptingApplyLifetime();
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(m_lifetimeMutex);
+		m_lifetimeChanges.insert(obj);
+		m_lifetimeChangesQueued.store(true);
+	}
+
+	// ************************************************************************************
+	void Engine::cancelLifetimeChange(ScriptableObject* obj) {
+		std::lock_guard<std::mutex> lock(m_lifetimeMutex);
+		m_lifetimeChanges.erase(obj);
+	}
+
+	// ************************************************************************************
+	void Engine::applyLifetimeChanges() {
+		if (!m_lifetimeChangesQueued.load()) return;
+
+		// objects cannot die here - wrapper holds reference until it is detached, which
+		// happens only on this thread (GC callback, dispose) and cancels the change
+		std::lock_guard<std::mutex> lock(m_lifetimeMutex);
+		m_lifetimeChangesQueued.store(false);
+		for(auto obj: m_lifetimeChanges) obj->scriptingApplyLifetime();
+		m_lifetimeChanges.clear();
+	}
+
+	// ************************************************************************************
+	void Engine::processDeferred() {
+		applyLifetimeChanges();
+
+		// handles of callers and exceptions dropped outside of scope
+		std::vector<v8::Global<v8::Function>> released;
+		std::vector<v8::Global<v8::Value>> releasedValues;
+		std::vector<v8::Global<v8::Message>> releasedMessages;
+		if (true) {
+			std::lock_guard<std::mutex> lock(m_functionCallers->mutex);
+			if (m_functionCallers->released.empty() && m_functionCallers->releasedValues.empty() && m_functionCallers->releasedMessages.empty()) return;
+			released.swap(m_functionCallers->released);
+			releasedValues.swap(m_functionCallers->releasedValues);
+			releasedMessages.swap(m_functionCallers->releasedMessages);
+		}
+		for(auto& handle: released) handle.Reset();
+		for(auto& handle: releasedValues) handle.Reset();
+		for(auto& handle: releasedMessages) handle.Reset();
+	}
+
+	// ************************************************************************************
+	void Engine::resetPeaks() {
+		v8::HeapStatistics heap;
+		m_isolate->GetHeapStatistics(&heap);
+
+		m_peakUsedHeap = heap.used_heap_size();
+		m_peakObjects = m_externalMemory.objects;
+		m_peakFunctions = m_externalMemory.functions;
+		m_peakExternalMemory = m_externalMemory.objectsMemory + m_externalMemory.functionsMemory;
+		for(auto& proto: m_prototypes) proto->peakWrappers = proto->liveWrappers;
+	}
+
 	// ************************************************************************************
 	void Engine::gc() {
 		v8::HeapStatistics stats;
 		m_isolate->GetHeapStatistics(&stats);
 		std::size_t used1 = stats.used_heap_size();
 
-		while (!m_isolate->IdleNotification(1000)) ;
+		m_gcPolicy->collectAll();
 
 		m_isolate->GetHeapStatistics(&stats);
 		std::size_t used2 = stats.used_heap_size();
@@ -25,13 +25,37 @@
 #define INCLUDE_SCRIPTING_ENGINE_H_
 
 #include "base.h"
+#include "gc.h"
+#include "arena.h"
+#include "stats.h"
 #include <v8.h>
 #include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <unordered_set>
 
 namespace scripting {
 
 	namespace internal {
 		class ObjectWrapperData;
+		class StructTemplateBase;
+		template<typename T> class StructTemplate;
+		class ViewSupport;
+		class ViewObject;
+		class MethodName;
+		class MethodCacheEntry;
+		class HeapTracer;
+	}
+	namespace functions {
+		class ScriptFunctionCaller;
+		struct FunctionCallerRegistry;
+		class AccessorHolderBase;
+		struct NativeSingletonEntry;
+		template<typename CLS> class NativeSingletonTemplate;
 	}
 	namespace functions {
 		typedef std::function<void(Engine* engine, const std::string& funcName, const v8::FunctionCallbackInfo<v8::Value>)> ScriptFunctor;
@@ -51,15 +75,55 @@ namespace scripting {
 			std::string m_msg;
 	};
 
+	namespace internal {
+		class ScriptExceptionState;
+	}
+
+	// exception thrown by script - only message and exception handles are kept when thrown,
+	// line, file and stack are looked up on first what() call (while engine is alive)
+	class ScriptException : public ScriptingException {
+		public:
+			ScriptException(Engine* engine, v8::TryCatch& tryCatch);
+			virtual ~ScriptException() throw() { }
+
+			virtual const char* what() const throw();
+		private:
+			std::shared_ptr<internal::ScriptExceptionState> m_state;
+	};
+
+
+	// failed call of batch invocation
+	struct BatchCallError {
+		std::size_t index;
+		std::string message;
+	};
+
+	enum class ExternalMemoryKind { OBJECT, FUNCTION };
+
+	// external memory accounted by engine, reported to v8 in batches
+	struct ExternalMemoryStats {
+		int64_t objectsMemory;
+		int64_t functionsMemory;
+		std::size_t objects;
+		std::size_t functions;
+		int64_t reported;
+		int64_t pending;
+	};
 
 	class Engine {
 		public:
+			// SHARED - isolate may be used from many threads, every scope takes v8::Locker
+			// OWNER - engine used only by thread which created it, no locking (checked in debug builds)
+			enum class ThreadingMode { SHARED, OWNER };
+
 			bool m_suppressCtorCallback;
 
-			static const std::size_t FUNCTION_OBJECT_SIZE = 1024;
+			static const int64_t EXTERNAL_MEMORY_BATCH = 64 * 1024;
+			static const std::size_t CONVERT_CHUNK_SIZE = 512;
+			static const std::size_t METHOD_CACHE_SIZE = 4096;
 			static const char* CORE_SCRIPT;
 
-			Engine();
+			Engine(ThreadingMode threadingMode = ThreadingMode::SHARED);
 			~Engine();
 
 			// helpers method
@@ -69,11 +133,13 @@ namespace scripting {
 			v8::Local<v8::Value> newNull();
 			v8::Local<v8::Value> newUndefined();
 			v8::Local<v8::String> newString(const std::string& v);
+			v8::Local<v8::String> newInternalizedString(const std::string& v);
 			v8::Local<v8::Integer> newInt(int32_t v);
 			v8::Local<v8::Number> newFloat(float v);
 			v8::Local<v8::Number> newDouble(double v);
 			v8::Local<v8::Boolean> newBoolean(bool v);
 			v8::Local<v8::Array> newArray(int n);
+			v8::Local<v8::Array> newArray(v8::Local<v8::Value>* values, std::size_t n);
 			v8::Local<v8::External> newExternal(void* ptr);
 
 			v8::Local<v8::Value> getWithProto(v8::Local<v8::Object> obj, const std::string& name);
@@ -105,8 +171,9 @@ namespace scripting {
 			template<class C, class B = ScriptableObject>
 			void registerNativeClass(const std::string& ns);
 
-			template<typename CLS, typename F>
-			void registerNativeClassMemberFunction(const std::string& name, const F& func);
+			// with more than one function, call is dispatched by arity and argument types
+			template<typename CLS, typename F, typename... OVERLOADS>
+			void registerNativeClassMemberFunction(const std::string& name, const F& func, const OVERLOADS&... overloads);
 
 			template<typename CLS, typename F>
 			void registerNativeClassStaticFunction(const std::string& name, const F& func);
@@ -120,6 +187,29 @@ namespace scripting {
 			template<typename CLS, typename GETTER, typename SETTER>
 			void registerNativeClassPropertyAccessor(const std::string& name, const GETTER& getter, const SETTER& setter);
 
+			template<typename CLS, typename OWNER, typename M>
+			void registerNativeClassField(const std::string& name, M OWNER::*member);
+
+			template<typename CLS, typename OWNER, typename M>
+			void registerNativeClassReadOnlyField(const std::string& name, M OWNER::*member);
+
+
+			// structs
+			template<typename T>
+			void registerStruct();
+
+			template<typename T>
+			internal::StructTemplate<T>* getStructTemplate();
+
+			// constants
+			template<typename... Args>
+			void registerConstants(const std::string& ns, const Args&... args);
+
+			template<typename E>
+			void registerEnum(const std::string& ns, std::initializer_list<std::pair<const char*, E>> values);
+
+			template<typename E>
+			const std::string& enumName(E value);
 
 			// singleton
 			void registerSingleton(const std::string& singletonName);
@@ -136,28 +226,86 @@ namespace scripting {
 			template<typename GETTER, typename SETTER>
 			void registerSingletonPropertyAccessor(const std::string& singletonName, const std::string& propertyName, const GETTER& getter, const SETTER& setter);
 
+			template<typename CLS>
+			functions::NativeSingletonTemplate<CLS> registerNativeSingleton(const std::string& singletonName, CLS* inst);
+
 
 			// object manipulation
 			template<typename R, typename... Args>
-			R CallScriptFunction(v8::Local<v8::Value> f, v8::Local<v8::Object> self, Args... args);
+			R CallScriptFunction(v8::Local<v8::Value> f, v8::Local<v8::Value> self, const Args&... args);
 
 			template<typename R, typename... Args>
-			R CallObjectPropertyWithSelf(v8::Local<v8::Object> obj, v8::Local<v8::Object> self, const std::string& propName, const Args... args);
+			R CallObjectPropertyWithSelf(v8::Local<v8::Object> obj, v8::Local<v8::Object> self, const std::string& propName, const Args&... args);
 
 			template<typename R, typename... Args>
-			R CallObjectProperty(v8::Local<v8::Object> obj, const std::string& propName, const Args... args);
+			R CallObjectProperty(v8::Local<v8::Object> obj, const std::string& propName, const Args&... args);
+			template<typename R, typename... Args>
+			R CallObjectProperty(v8::Local<v8::Object> obj, internal::MethodName* name, const Args&... args);
 
 			template<typename T>
 			T GetObjectProperty(v8::Local<v8::Object> obj, const std::string& propName);
 
+			// method lookup cache
+			internal::MethodName* internMethodName(const std::string& name);
+			v8::Local<v8::Value> findMethod(v8::Local<v8::Object> obj, internal::MethodName* name);
+			// cached methods are trusted until next compile or native registration - call it when
+			// script redefines prototype methods at run time
+			void invalidateMethodCache() { ++m_methodCacheGeneration; }
+			// eventCallStatic / eventCallStaticReturn of $ object
+			internal::MethodName* eventDispatcherName(bool returning);
+
 			template<typename... Args>
-			bool CallGlobalObjectEvent(const std::string& objName, const std::string& name, Args... args);
+			bool CallGlobalObjectEvent(const std::string& objName, const std::string& name, const Args&... args);
+
+			// batch calls - one scope for all receivers, errors collected per call; stops after terminated execution
+			template<typename... Args, typename RECEIVERS, typename PROVIDER>
+			std::vector<BatchCallError> invokeBatch(v8::Local<v8::Value> func, const RECEIVERS& receivers, const PROVIDER& argsProvider);
+
+			template<typename... Args, typename RECEIVERS, typename PROVIDER>
+			std::vector<BatchCallError> invokeBatch(const std::string& methodName, const RECEIVERS& receivers, const PROVIDER& argsProvider);
+
+			template<typename RECEIVERS>
+			std::vector<BatchCallError> invokeBatch(v8::Local<v8::Value> func, const RECEIVERS& receivers);
+
+			template<typename RECEIVERS>
+			std::vector<BatchCallError> invokeBatch(const std::string& methodName, const RECEIVERS& receivers);
+
+			std::string describeException(v8::TryCatch& tryCatch);
+			std::string describeException(v8::Local<v8::Value> exception, v8::Local<v8::Message> msg);
+
+			// callers of script functions, shared per function identity
+			stdext::object_ptr<functions::ScriptFunctionCaller> getFunctionCaller(v8::Local<v8::Value> f);
+
+			// external memory accounting
+			void externalMemoryAllocated(ExternalMemoryKind kind, int64_t bytes);
+			void externalMemoryReleased(ExternalMemoryKind kind, int64_t bytes);
+			void flushExternalMemory();
+			const ExternalMemoryStats& externalMemoryStats() const { return m_externalMemory; }
+
+			// heap and bindings statistics, also available in JS as ScriptingStats.get()
+			EngineStats stats();
+			void resetPeaks();
+
+			// STRONG_WHILE_NATIVE_ALIVE wrappers - handle is switched strong/weak at once when calling
+			// thread holds isolate, otherwise later under isolate lock (applyLifetimeChanges)
+			void queueLifetimeChange(ScriptableObject* obj);
+			void cancelLifetimeChange(ScriptableObject* obj);
+			void applyLifetimeChanges();
+
+			// work queued from other threads, done at outermost ScriptingScope
+			void processDeferred();
+			// calling thread has isolate entered (and locked in SHARED mode)
+			bool holdsIsolate() const;
 
 			// other methods
 
 			void runFile(const std::string& path);
 			void runString(const std::string& origin, const std::string& content);
+
+			// full collection, for periodic work in idle time use gcPolicy().idle(budget)
 			void gc();
+			GcPolicy& gcPolicy() { return *m_gcPolicy; }
+			FinalizationQueue& finalizationQueue() { return *m_finalizationQueue; }
 
 			template<typename RET, typename... Args>
 			std::function<RET(Args...)> compileFunction(const std::string& origin, const std::string& func);
@@ -167,6 +315,10 @@ namespace scripting {
 			void CallInObjectContext(v8::Local<v8::Object> obj, const std::string& origin, const std::string& code);
 
 			v8::Isolate* isolate() { return m_isolate; }
+			v8::Platform* platform() { return m_platform; }
+			internal::HeapTracer* heapTracer() { return m_heapTracer; }
+			internal::BindingArena& bindingArena() { return *m_bindingArena; }
+			ThreadingMode threadingMode() const { return m_threadingMode; }
 			v8::Local<v8::Context> context() { return m_context.Get(m_isolate); }
 			v8::Local<v8::Value> getGlobalValue(const std::string& name);
 			v8::Local<v8::Object> getGlobalObject(const std::string& name);
@@ -182,8 +334,12 @@ namespace scripting {
 					std::string prototypeName;
 					stdext::demangled_name nativeClassName;
 					v8::FunctionCallback ctor;
+					std::size_t nativeSize;
+					uint32_t index;
+					std::size_t liveWrappers;
+					std::size_t peakWrappers;
 
-					Prototype(Engine* engine) : engine(engine), basePrototype(nullptr), ctor(nullptr) { }
+					Prototype(Engine* engine) : engine(engine), basePrototype(nullptr), ctor(nullptr), nativeSize(0), index(0), liveWrappers(0), peakWrappers(0) { }
 					v8::Local<v8::FunctionTemplate> GetTemplate() { return tpl.Get(engine->isolate()); }
 					v8::Local<v8::Object> NewInstance() {
 						engine->m_suppressCtorCallback = true;
@@ -196,34 +352,99 @@ namespace scripting {
 			Prototype* findPrototypeByName(const std::string& name);
 			Prototype* findPrototypeByNativeClassName(const stdext::demangled_name& name);
 			Prototype* findFirstNativePrototypeByName(const std::string& name);
+			Prototype* prototypeAt(uint32_t index) { return (index < m_prototypes.size()) ? m_prototypes[index] : nullptr; }
 
 		private:
 			v8::Persistent<v8::Context> m_context;
 			v8::Isolate* m_isolate;
 			v8::Platform* m_platform;
+			ThreadingMode m_threadingMode;
+			std::thread::id m_ownerThread;
 
 			std::vector<Prototype*> m_prototypes;
-
-			v8::Local<v8::Function> newFunctionInternal(const std::string& name, const functions::ScriptFunctor& func);
+			std::unordered_map<const std::string*, Prototype*> m_prototypesByName;			// keys interned in m_bindingArena
+			std::unordered_map<const std::string*, Prototype*> m_prototypesByNativeName;
+			std::vector<internal::StructTemplateBase*> m_structs;
+			internal::ViewSupport* m_viewSupport;
+			std::vector<functions::AccessorHolderBase*> m_accessors;
+			std::vector<std::unordered_map<int64_t, std::string>> m_enumNames;
+			std::unordered_map<std::string, internal::MethodName*> m_methodNames;
+			std::unordered_multimap<int, internal::MethodCacheEntry*> m_methodCache;
+			uint32_t m_methodCacheGeneration;
+			internal::MethodName* m_eventCallName;
+			internal::MethodName* m_eventCallReturnName;
+			std::shared_ptr<functions::FunctionCallerRegistry> m_functionCallers;
+			ExternalMemoryStats m_externalMemory;
+			GcPolicy* m_gcPolicy;
+			FinalizationQueue* m_finalizationQueue;
+			internal::BindingArena* m_bindingArena;
+			internal::HeapTracer* m_heapTracer;
+			std::size_t m_peakUsedHeap;
+			std::size_t m_peakObjects;
+			std::size_t m_peakFunctions;
+			int64_t m_peakExternalMemory;
+			std::mutex m_lifetimeMutex;
+			std::unordered_set<ScriptableObject*> m_lifetimeChanges;
+			std::atomic<bool> m_lifetimeChangesQueued;
+
+			// registration names are interned; names of functions created at run time are kept by the function
+			v8::Local<v8::Function> newFunctionInternal(const std::string& name, const functions::ScriptFunctor& func, bool internName = true);
+			void registerNativeAccessor(Prototype* prototype, const std::string& propName, v8::AccessorNameGetterCallback getter, v8::AccessorNameSetterCallback setter, functions::AccessorHolderBase* holder);
+			void installNativeSingleton(const std::string& singletonName, void* inst, std::vector<functions::NativeSingletonEntry>& entries);
+			void installConstants(const std::string& ns, v8::Local<v8::ObjectTemplate> tpl);
+
+			template<typename... Args, typename RECEIVERS, typename PROVIDER>
+			std::vector<BatchCallError> invokeBatchInternal(v8::Local<v8::Value> func, internal::MethodName* methodName, const RECEIVERS& receivers, const PROVIDER& argsProvider);
 
 			friend class ScriptingScope;
+			friend class ScriptException;
+			friend class internal::ScriptExceptionState;
+			friend class internal::ViewObject;
+			template<typename CLS> friend class functions::NativeSingletonTemplate;
 	};
 
+	namespace internal {
+		// scope object constructed only when enabled
+		template<typename T>
+		class OptionalScope {
+			public:
+				template<typename A>
+				OptionalScope(bool enabled, A arg) : m_enabled(enabled) {
+					if (m_enabled) ::new (&m_storage) T(arg);
+				}
+				~OptionalScope() {
+					if (m_enabled) reinterpret_cast<T*>(&m_storage)->~T();
+				}
+
+			private:
+				OptionalScope(const OptionalScope& from);
+				OptionalScope& operator=(const OptionalScope& a);
+
+				typename std::aligned_storage<sizeof(T), alignof(T)>::type m_storage;
+				bool m_enabled;
+		};
+	}
+
 	class ScriptingScope {
 		private:
 			ScriptingScope(const ScriptingScope& from);
 			ScriptingScope& operator=(const ScriptingScope& a);
 
 			Engine* m_engine;
-			v8::Locker m_locker;
-			v8::Isolate::Scope m_isolateScope;
+			bool m_nested;
+			internal::OptionalScope<v8::Locker> m_locker;
+			internal::OptionalScope<v8::Isolate::Scope> m_isolateScope;
 			v8::HandleScope m_handleScope;
-			v8::Context::Scope m_contextScope;
+			internal::OptionalScope<v8::Context::Scope> m_contextScope;
 			v8::TryCatch m_tryCatch;
 
+			static bool isEntered(Engine* e);
 
 		public:
-			ScriptingScope(Engine* e) : m_engine(e), m_locker(e->m_isolate), m_isolateScope(e->m_isolate), m_handleScope(e->m_isolate), m_contextScope(e->m_context.Get(e->m_isolate)), m_tryCatch(e->m_isolate) { }
+			// when already inside engine (eg. in JS->native callback) only HandleScope and TryCatch are set up
+			ScriptingScope(Engine* e) : m_engine(e), m_nested(isEntered(e)), m_locker(!m_nested && e->m_threadingMode == Engine::ThreadingMode::SHARED, e->m_isolate), m_isolateScope(!m_nested, e->m_isolate), m_handleScope(e->m_isolate), m_contextScope(!m_nested, e->m_context.Get(e->m_isolate)), m_tryCatch(e->m_isolate) { enter(); }
+			~ScriptingScope();
+			void enter();
 			v8::Local<v8::Context> context() { return m_engine->m_context.Get(m_engine->m_isolate); }
 
 			v8::Local<v8::String> newString(const std::string& v) { return m_engine->newString(v); }
@@ -240,9 +461,14 @@ namespace scripting {
 
 #define INCLUDING_FROM_ENGINE
 #	include "converters.h"
+#	include "structs.h"
+#	include "view.h"
+#	include "args.h"
 #	include "object.h"
+#	include "tracing.h"
 #	include "internal.h"
 #	include "functionwrapper.h"
+#	include "methods.h"
 #undef INCLUDING_FROM_ENGINE
 
 // converters for std::function
@@ -265,25 +491,43 @@ namespace scripting { namespace converters {
 		static_assert(std::is_base_of<ScriptableObject, T>::value, "cannot convert not base of ScriptableObject");
 
 		out.reset();
-		if (v.IsEmpty()) return;
-		if (!v->IsObject()) return;
-
-		v8::Local<v8::Object> obj = v8::Local<v8::Object>::Cast(v);
-		if (obj->InternalFieldCount() == 0) return;
 
-		auto scriptObject = (stdext::object_ptr<ScriptableObject>*)v8::Local<v8::External>::Cast(obj->GetInternalField(0))->Value();
+		auto scriptObject = ScriptableObject::scriptingWrapperSlot(v);
 		if (scriptObject == nullptr) return;
 
 		out = (*scriptObject)->dynamic_self_cast<T>();
 	}
 
 	template<typename T>
-	v8::Local<v8::Value> convertTo(Engine* engine, const std::vector<T>& v) {
-		v8::Local<v8::Array> arr = engine->newArray(v.size());
-		for(std::size_t i=0;i<v.size();++i) {
-			arr->Set(i, convertTo(engine, v[i]));
+	v8::Local<v8::Value> convertTo(Engine* engine, const stdext::weak_object_ptr<T>& v) {
+		static_assert(std::is_base_of<ScriptableObject, T>::value, "cannot convert not base of ScriptableObject");
+
+		stdext::object_ptr<T> target = v.lock();
+		if (target.empty()) return engine->newNull();
+
+		stdext::object_ptr<WeakReference> ref = new WeakReference(stdext::weak_object_ptr<ScriptableObject>(target.get()));
+		ref->scriptingSetClassNameInternal("WeakReference");
+		return ref->scriptingGetObject();
+	}
+
+	template<typename T>
+	void convertFrom(Engine* engine, v8::Local<v8::Value> v, stdext::weak_object_ptr<T>& out) {
+		// accepts WeakReference (without resurrecting target) or wrapped object itself
+		stdext::object_ptr<ScriptableObject> obj;
+		convertFrom(engine, v, obj);
+		out.reset();
+		if (obj.empty()) return;
+
+		if (WeakReference* ref = dynamic_cast<WeakReference*>(obj.get())) {
+			obj = ref->get();
+			if (obj.empty()) return;
 		}
-		return arr;
+		out = obj->dynamic_self_cast<T>();
+	}
+
+	template<typename T>
+	v8::Local<v8::Value> convertTo(Engine* engine, const std::vector<T>& v) {
+		return internal::ConvertRangeToArray(engine, v.begin(), v.size());
 	}
 
 	template<typename T>
@@ -293,49 +537,113 @@ namespace scripting { namespace converters {
 		v8::Local<v8::Array> arr = v8::Local<v8::Array>::Cast(v);
 
 		out.clear();
-		for(uint32_t i=0;i<arr->Length();++i) {
-			out.push_back(ConverterHelper<T>::from(engine, arr->Get(i)));
-		}
+		internal::ConvertArrayElements(engine, arr, out);
 	}
 
 	template<typename T>
 	v8::Local<v8::Value> convertTo(Engine* engine, const std::list<T>& v) {
-		v8::Local<v8::Array> arr = engine->newArray(v.size());
-		int32_t i=0;
-		for(auto it=v.begin();it != v.end();++it) {
-			arr->Set(i, convertTo(engine, *it));
-			i += 1;
-		}
-		return arr;
+		return internal::ConvertRangeToArray(engine, v.begin(), v.size());
+	}
+
+	template<typename T>
+	void convertFrom(Engine* engine, v8::Local<v8::Value> v, std::list<T>& out) {
+		if (v.IsEmpty()) return;
+		if (!v->IsArray()) return;
+		v8::Local<v8::Array> arr = v8::Local<v8::Array>::Cast(v);
+
+		out.clear();
+		internal::ConvertArrayElements(engine, arr, out);
 	}
 
 	template<typename T>
 	v8::Local<v8::Value> convertTo(Engine* engine, const std::deque<T>& v) {
-		v8::Local<v8::Array> arr = engine->newArray(v.size());
-		int32_t i=0;
-		for(auto it=v.begin();it != v.end();++it) {
-			arr->Set(i, convertTo(engine, *it));
-			i += 1;
-		}
-		return arr;
+		return internal::ConvertRangeToArray(engine, v.begin(), v.size());
 	}
 
 	template<typename T>
-	v8::Local<v8::Value> convertTo(Engine* engine, const std::map<int, T>& v) {
-		v8::Local<v8::Object> obj = engine->newAnonymousObject();
-		for(auto it=v.begin();it != v.end();++it) {
-			obj->CreateDataProperty(engine->context(), it->first, convertTo(engine, it->second));
+	void convertFrom(Engine* engine, v8::Local<v8::Value> v, std::deque<T>& out) {
+		if (v.IsEmpty()) return;
+		if (!v->IsArray()) return;
+		v8::Local<v8::Array> arr = v8::Local<v8::Array>::Cast(v);
+
+		out.clear();
+		internal::ConvertArrayElements(engine, arr, out);
+	}
+
+	template<typename T>
+	v8::Local<v8::Value> convertTo(Engine* engine, const std::set<T>& v) {
+		return internal::ConvertRangeToArray(engine, v.begin(), v.size());
+	}
+
+	template<typename T>
+	void convertFrom(Engine* engine, v8::Local<v8::Value> v, std::set<T>& out) {
+		if (v.IsEmpty()) return;
+		if (!v->IsArray()) return;
+		v8::Local<v8::Array> arr = v8::Local<v8::Array>::Cast(v);
+
+		out.clear();
+		internal::ConvertArrayElements(engine, arr, out);
+	}
+
+	template<typename K, typename V>
+	v8::Local<v8::Value> convertTo(Engine* engine, const std::map<K, V>& v) {
+		return internal::ConvertPairsToObject(engine, v.begin(), v.end());
+	}
+
+	template<typename K, typename V>
+	void convertFrom(Engine* engine, v8::Local<v8::Value> v, std::map<K, V>& out) {
+		if (v.IsEmpty()) return;
+		if (!v->IsObject()) return;
+
+		out.clear();
+		internal::ConvertObjectEntries(engine, v8::Local<v8::Object>::Cast(v), out);
+	}
+
+	template<typename K, typename V>
+	v8::Local<v8::Value> convertTo(Engine* engine, const std::unordered_map<K, V>& v) {
+		return internal::ConvertPairsToObject(engine, v.begin(), v.end());
+	}
+
+	template<typename K, typename V>
+	void convertFrom(Engine* engine, v8::Local<v8::Value> v, std::unordered_map<K, V>& out) {
+		if (v.IsEmpty()) return;
+		if (!v->IsObject()) return;
+
+		out.clear();
+		internal::ConvertObjectEntries(engine, v8::Local<v8::Object>::Cast(v), out);
+	}
+
+	template<typename T>
+	typename std::enable_if<is_reflected_struct<T>::value, v8::Local<v8::Value>>::type convertTo(Engine* engine, const T& v) {
+		internal::StructTemplate<T>* st = engine->getStructTemplate<T>();
+		v8::Local<v8::Context> context = engine->context();
+
+		v8::Local<v8::Object> obj;
+		if (!st->GetTemplate(engine->isolate())->NewInstance(context).ToLocal(&obj)) return engine->newUndefined();
+
+		for(auto& field: st->descriptor.fields()) {
+			// failed field converter leaves exception pending, rest is not converted
+			v8::Local<v8::Value> val = field->get(engine, v);
+			if (val.IsEmpty() || !obj->CreateDataProperty(context, field->key.Get(engine->isolate()), val).FromMaybe(false)) break;
 		}
 		return obj;
 	}
 
 	template<typename T>
-	v8::Local<v8::Value> convertTo(Engine* engine, const std::map<std::string, T>& v) {
-		v8::Local<v8::Object> obj = engine->newAnonymousObject();
-		for(auto it=v.begin();it != v.end();++it) {
-			obj->CreateDataProperty(engine->context(), engine->newString(it->first), convertTo(engine, it->second));
+	typename std::enable_if<is_reflected_struct<T>::value>::type convertFrom(Engine* engine, v8::Local<v8::Value> v, T& out) {
+		if (v.IsEmpty()) return;
+		if (!v->IsObject()) return;
+
+		internal::StructTemplate<T>* st = engine->getStructTemplate<T>();
+		v8::Local<v8::Context> context = engine->context();
+		v8::Local<v8::Object> obj = v8::Local<v8::Object>::Cast(v);
+
+		for(auto& field: st->descriptor.fields()) {
+			v8::Local<v8::Value> val;
+			if (obj->Get(context, field->key.Get(engine->isolate())).ToLocal(&val) && !val->IsUndefined()) {
+				field->set(engine, val, out);
+			}
 		}
-		return obj;
 	}
 
 	template<typename R, typename... Args>
@@ -345,16 +653,16 @@ namespace scripting { namespace converters {
 
 	template<typename R, typename... Args>
 	void convertFrom(Engine* engine, v8::Local<v8::Value> v, std::function<R(Args...)>& out) {
-		functions::ScriptFunctionCallerPtr caller(new functions::ScriptFunctionCaller(engine, v));
+		functions::ScriptFunctionCallerPtr caller = engine->getFunctionCaller(v);
 		out = functions::ScriptFunctionCallerExecutor<R,Args...>(caller);
 	}
 
-	template<typename T,class=typename std::enable_if<std::is_enum<T>::value>::type>
+	template<typename T,class>
 	v8::Local<v8::Value> convertTo(Engine* engine, const T& v) {
 		return engine->newInt((int32_t)v);
 	}
 
-	template<typename T,class=typename std::enable_if<std::is_enum<T>::value>::type>
+	template<typename T,class>
 	void convertFrom(Engine* engine, v8::Local<v8::Value> v, T& out) {
 		int32_t tmp = 0;
 		convertFrom(engine, v, tmp);
@@ -397,7 +705,7 @@ namespace scripting {
 	// ************************************************************************************
 	template<typename F>
 	v8::Local<v8::Function> Engine::newFunction(const std::string& name, const F& func) {
-		return newFunctionInternal(name, functions::makeStatic(func));
+		return newFunctionInternal(name, functions::makeStatic(func), false);
 	}
 
 	// ************************************************************************************
@@ -425,6 +733,81 @@ namespace scripting {
 		scope.checkThrowException();
 	}
 
+	// ************************************************************************************
+	template<typename T>
+	void Engine::registerStruct() {
+		ScriptingScope scope(this);
+		getStructTemplate<T>();
+	}
+
+	// ************************************************************************************
+	template<typename T>
+	internal::StructTemplate<T>* Engine::getStructTemplate() {
+		uint32_t id = internal::StructTypeId<T>::get();
+		if (id < m_structs.size() && m_structs[id] != nullptr) {
+			return static_cast<internal::StructTemplate<T>*>(m_structs[id]);
+		}
+
+		internal::StructTemplate<T>* st = new internal::StructTemplate<T>();
+		T::scriptingStruct(st->descriptor);
+
+		v8::HandleScope handleScope(m_isolate);
+		v8::Local<v8::ObjectTemplate> tpl = v8::ObjectTemplate::New(m_isolate);
+		for(auto& field: st->descriptor.fields()) {
+			v8::Local<v8::String> key = newInternalizedString(field->name);
+			field->key.Reset(m_isolate, key);
+			tpl->Set(key, newUndefined());
+		}
+		st->tpl.Reset(m_isolate, tpl);
+
+		if (id >= m_structs.size()) m_structs.resize(id + 1, nullptr);
+		m_structs[id] = st;
+		return st;
+	}
+
+	// ************************************************************************************
+	template<typename... Args>
+	void Engine::registerConstants(const std::string& ns, const Args&... args) {
+		static_assert(sizeof...(Args) % 2 == 0, "constants must be given as name, value pairs");
+
+		ScriptingScope scope(this);
+		v8::Local<v8::ObjectTemplate> tpl = v8::ObjectTemplate::New(m_isolate);
+		internal::SetTemplateConstants(this, tpl, args...);
+		installConstants(ns, tpl);
+	}
+
+	// ************************************************************************************
+	template<typename E>
+	void Engine::registerEnum(const std::string& ns, std::initializer_list<std::pair<const char*, E>> values) {
+		static_assert(std::is_enum<E>::value, "registerEnum requires enum type");
+
+		uint32_t id = internal::EnumTypeId<E>::get();
+		if (id >= m_enumNames.size()) m_enumNames.resize(id + 1);
+		auto& names = m_enumNames[id];
+
+		ScriptingScope scope(this);
+		v8::Local<v8::ObjectTemplate> tpl = v8::ObjectTemplate::New(m_isolate);
+		for(auto& entry: values) {
+			internal::SetTemplateConstant(this, tpl, entry.first, converters::convertTo(this, entry.second));
+			// for aliased values first name wins
+			names.insert(std::make_pair((int64_t)entry.second, std::string(entry.first)));
+		}
+		installConstants(ns, tpl);
+	}
+
+	// ************************************************************************************
+	template<typename E>
+	const std::string& Engine::enumName(E value) {
+		static const std::string empty;
+
+		uint32_t id = internal::EnumTypeId<E>::get();
+		if (id < m_enumNames.size()) {
+			auto it = m_enumNames[id].find((int64_t)value);
+			if (it != m_enumNames[id].end()) return it->second;
+		}
+		return empty;
+	}
+
 	// ************************************************************************************
 	template<class C, class B>
 	void Engine::registerNativeClass(const std::string& ns) {
@@ -436,20 +819,28 @@ namespace scripting {
 
 		std::string prototypeName = internal::normalizePrototypeName(currNativeClassName.last(), ns);
 		registerPrototype(prototypeName, basePrototype->prototypeName, currNativeClassName, &functions::ConstructorCallback<C>);
+		findPrototypeByName(prototypeName)->nativeSize = sizeof(C);
 	}
 
 	// ************************************************************************************
-	template<typename CLS, typename F>
-	void Engine::registerNativeClassMemberFunction(const std::string& methodName, const F& func) {
+	template<typename CLS, typename F, typename... OVERLOADS>
+	void Engine::registerNativeClassMemberFunction(const std::string& methodName, const F& func, const OVERLOADS&... overloads) {
 		ScriptingScope scope(this);
 		auto nativeClassName = stdext::demangled_name::get<CLS>();
 		auto prototype = findPrototypeByNativeClassName(nativeClassName);
 		if (prototype == nullptr) throw ScriptingException(stdext::format("Could not find prototype for %s", nativeClassName.full()));
 
+		functions::ScriptFunctor functor;
+		if (sizeof...(OVERLOADS) == 0) {
+			functor = functions::makeClassMember<CLS>(func);
+		} else {
+			functor = functions::makeOverloaded<CLS>(func, overloads...);
+		}
+
 		// trzeba utworzyc funkcje
 		v8::Local<v8::Function> tpl = newFunctionInternal(
 			stdext::format("[%s].%s", nativeClassName.full(), methodName),
-			functions::makeClassMember<CLS>(func)
+			functor
 		);
 
 		v8::Local<v8::Object> global = m_context.Get(m_isolate)->Global();
@@ -530,24 +921,9 @@ namespace scripting {
 		auto prototype = findPrototypeByNativeClassName(nativeClassName);
 		if (prototype == nullptr) throw ScriptingException(stdext::format("Could not find prototype for %s", nativeClassName.full()));
 
-		// trzeba utworzyc funkcje
-		v8::Local<v8::Function> getterFunc = newFunctionInternal(
-			stdext::format("[%s].[getter:%s]", nativeClassName.full(), propName),
-			functions::makeClassMember<CLS>(getter)
-		);
-
-		// ustawianie
-		v8::Local<v8::Object> global = m_context.Get(m_isolate)->Global();
-		auto func = compileFunctionRaw(
-			stdext::format("<registerClassProperty [%s].%s>", nativeClassName.full(),propName),
-			stdext::format("function(getter,setter){ Object.defineProperty(%s.prototype, '%s', { enumerable: true, configurable: false, get: getter, set: setter }); }", prototype->prototypeName, propName)
-		);
-		assert(!func.IsEmpty());
-
-		v8::Local<v8::Value> args[3];
-		args[0] = getterFunc;
-		args[1] = newUndefined();
-		func->Call(context(), global, 2, args);
+		typedef functions::GetterHolder<CLS,GETTER> Holder;
+		Holder* holder = new Holder(this, stdext::format("[%s].%s", nativeClassName.full(), propName), getter);
+		registerNativeAccessor(prototype, propName, &Holder::Getter, nullptr, holder);
 
 		scope.checkThrowException();
 	}
@@ -560,28 +936,44 @@ namespace scripting {
 		auto prototype = findPrototypeByNativeClassName(nativeClassName);
 		if (prototype == nullptr) throw ScriptingException(stdext::format("Could not find prototype for %s", nativeClassName.full()));
 
-		// trzeba utworzyc funkcje
-		v8::Local<v8::Function> getterFunc = newFunctionInternal(
-			stdext::format("[%s].[getter:%s]", nativeClassName.full(), propName),
-			functions::makeClassMember<CLS>(getter)
-		);
-		v8::Local<v8::Function> setterFunc = newFunctionInternal(
-			stdext::format("[%s].[setter:%s]", nativeClassName.full(), propName),
-			functions::makeClassMember<CLS>(setter)
-		);
+		typedef functions::AccessorHolder<CLS,GETTER,SETTER> Holder;
+		Holder* holder = new Holder(this, stdext::format("[%s].%s", nativeClassName.full(), propName), getter, setter);
+		registerNativeAccessor(prototype, propName, &Holder::Getter, &Holder::Setter, holder);
 
-		// ustawianie
-		v8::Local<v8::Object> global = m_context.Get(m_isolate)->Global();
-		auto func = compileFunctionRaw(
-			stdext::format("<registerClassProperty [%s].%s>", nativeClassName.full(),propName),
-			stdext::format("function(getter,setter){ Object.defineProperty(%s.prototype, '%s', { enumerable: true, configurable: false, get: getter, set: setter }); }", prototype->prototypeName, propName)
-		);
-		assert(!func.IsEmpty());
+		scope.checkThrowException();
+	}
 
-		v8::Local<v8::Value> args[3];
-		args[0] = getterFunc;
-		args[1] = setterFunc;
-		func->Call(context(), global, 2, args);
+	// ************************************************************************************
+	template<typename CLS, typename OWNER, typename M>
+	void Engine::registerNativeClassField(const std::string& fieldName, M OWNER::*member) {
+		static_assert(std::is_base_of<OWNER, CLS>::value, "field must be member of class or its base");
+		static_assert(!std::is_const<M>::value, "const field can be registered only as read only");
+
+		ScriptingScope scope(this);
+		auto nativeClassName = stdext::demangled_name::get<CLS>();
+		auto prototype = findPrototypeByNativeClassName(nativeClassName);
+		if (prototype == nullptr) throw ScriptingException(stdext::format("Could not find prototype for %s", nativeClassName.full()));
+
+		typedef functions::FieldHolder<CLS,OWNER,M> Holder;
+		Holder* holder = new Holder(this, stdext::format("[%s].%s", nativeClassName.full(), fieldName), member);
+		registerNativeAccessor(prototype, fieldName, &Holder::Getter, &Holder::Setter, holder);
+
+		scope.checkThrowException();
+	}
+
+	// ************************************************************************************
+	template<typename CLS, typename OWNER, typename M>
+	void Engine::registerNativeClassReadOnlyField(const std::string& fieldName, M OWNER::*member) {
+		static_assert(std::is_base_of<OWNER, CLS>::value, "field must be member of class or its base");
+
+		ScriptingScope scope(this);
+		auto nativeClassName = stdext::demangled_name::get<CLS>();
+		auto prototype = findPrototypeByNativeClassName(nativeClassName);
+		if (prototype == nullptr) throw ScriptingException(stdext::format("Could not find prototype for %s", nativeClassName.full()));
+
+		typedef functions::FieldHolder<CLS,OWNER,M> Holder;
+		Holder* holder = new Holder(this, stdext::format("[%s].%s", nativeClassName.full(), fieldName), member);
+		registerNativeAccessor(prototype, fieldName, &Holder::Getter, nullptr, holder);
 
 		scope.checkThrowException();
 	}
@@ -717,9 +1109,16 @@ namespace scripting {
 	}
 
 
+	// ************************************************************************************
+	template<typename CLS>
+	functions::NativeSingletonTemplate<CLS> Engine::registerNativeSingleton(const std::string& singletonName, CLS* inst) {
+		if (inst == nullptr) throw ScriptingException(stdext::format("Singleton %s instance is null", singletonName));
+		return functions::NativeSingletonTemplate<CLS>(this, singletonName, inst);
+	}
+
 	// ************************************************************************************
 	template<typename R, typename... Args>
-	R Engine::CallScriptFunction(v8::Local<v8::Value> f, v8::Local<v8::Object> self, Args... args) {
+	R Engine::CallScriptFunction(v8::Local<v8::Value> f, v8::Local<v8::Value> self, const Args&... args) {
 		if (f.IsEmpty()) return R();
 		if (!f->IsFunction()) return R();
 
@@ -736,7 +1135,7 @@ namespace scripting {
 
 	// ************************************************************************************
 	template<typename R, typename... Args>
-	R Engine::CallObjectPropertyWithSelf(v8::Local<v8::Object> obj, v8::Local<v8::Object> self, const std::string& propName, const Args... args) {
+	R Engine::CallObjectPropertyWithSelf(v8::Local<v8::Object> obj, v8::Local<v8::Object> self, const std::string& propName, const Args&... args) {
 		v8::Local<v8::Value> funcV = getWithProto(obj, propName);
 		if (!funcV.IsEmpty() && funcV->IsFunction()) {
 			v8::Local<v8::Function> f = v8::Local<v8::Function>::Cast(funcV);
@@ -748,27 +1147,14 @@ namespace scripting {
 
 	// ************************************************************************************
 	template<typename R, typename... Args>
-	R Engine::CallObjectProperty(v8::Local<v8::Object> obj, const std::string& propName, const Args... args) {
-
-		v8::Local<v8::Object> self = obj;
-		v8::Local<v8::String> pn = newString(propName);
-
-		while(!obj.IsEmpty()) {
-			v8::Local<v8::Value> val = obj->Get(pn);
-			if (!val.IsEmpty() && val->IsFunction()) {
-				v8::Local<v8::Function> f = v8::Local<v8::Function>::Cast(val);
-				return CallScriptFunction<R>(f, self, args...);
-			}
+	R Engine::CallObjectProperty(v8::Local<v8::Object> obj, const std::string& propName, const Args&... args) {
+		return CallScriptFunction<R>(findMethod(obj, internMethodName(propName)), obj, args...);
+	}
 
-			v8::Local<v8::Value> proto = obj->GetPrototype();
-			if (!proto.IsEmpty() && proto->IsObject()) {
-				obj = v8::Local<v8::Object>::Cast(proto);
-			} else {
-				break;
-			}
-		}
-		utils::logWarning(stdext::format("Could not find function %s", propName));
-		return R();
+	// ************************************************************************************
+	template<typename R, typename... Args>
+	R Engine::CallObjectProperty(v8::Local<v8::Object> obj, internal::MethodName* name, const Args&... args) {
+		return CallScriptFunction<R>(findMethod(obj, name), obj, args...);
 	}
 
 	// ************************************************************************************
@@ -787,14 +1173,14 @@ namespace scripting {
 
 	// ************************************************************************************
 	template<typename... Args>
-	bool Engine::CallGlobalObjectEvent(const std::string& objName, const std::string& name, Args... args) {
+	bool Engine::CallGlobalObjectEvent(const std::string& objName, const std::string& name, const Args&... args) {
 		ScriptingScope scope(this);
 
 		v8::Local<v8::Object> obj = getGlobalObject(objName);
 		v8::Local<v8::Function> dollarFunc = getGlobalFunction("$");
 
 		if (!dollarFunc.IsEmpty() && !obj.IsEmpty()) {
-			bool res = g_engineScripting->CallObjectProperty<bool>(dollarFunc, "eventCallStatic", obj, name, args...);
+			bool res = CallObjectProperty<bool>(dollarFunc, eventDispatcherName(false), obj, name, args...);
 			scope.checkThrowException();
 			return res;
 		}
@@ -803,10 +1189,82 @@ namespace scripting {
 	}
 
 
+	// ************************************************************************************
+	template<typename... Args, typename RECEIVERS, typename PROVIDER>
+	std::vector<BatchCallError> Engine::invokeBatch(v8::Local<v8::Value> func, const RECEIVERS& receivers, const PROVIDER& argsProvider) {
+		return invokeBatchInternal<Args...>(func, nullptr, receivers, argsProvider);
+	}
+
+	// ************************************************************************************
+	template<typename... Args, typename RECEIVERS, typename PROVIDER>
+	std::vector<BatchCallError> Engine::invokeBatch(const std::string& methodName, const RECEIVERS& receivers, const PROVIDER& argsProvider) {
+		ScriptingScope scope(this);
+		return invokeBatchInternal<Args...>(v8::Local<v8::Value>(), internMethodName(methodName), receivers, argsProvider);
+	}
+
+	// ************************************************************************************
+	template<typename RECEIVERS>
+	std::vector<BatchCallError> Engine::invokeBatch(v8::Local<v8::Value> func, const RECEIVERS& receivers) {
+		return invokeBatchInternal<>(func, nullptr, receivers, internal::NoBatchArgs());
+	}
+
+	// ************************************************************************************
+	template<typename RECEIVERS>
+	std::vector<BatchCallError> Engine::invokeBatch(const std::string& methodName, const RECEIVERS& receivers) {
+		ScriptingScope scope(this);
+		return invokeBatchInternal<>(v8::Local<v8::Value>(), internMethodName(methodName), receivers, internal::NoBatchArgs());
+	}
+
+	// ************************************************************************************
+	template<typename... Args, typename RECEIVERS, typename PROVIDER>
+	std::vector<BatchCallError> Engine::invokeBatchInternal(v8::Local<v8::Value> func, internal::MethodName* methodName, const RECEIVERS& receivers, const PROVIDER& argsProvider) {
+		ScriptingScope scope(this);
+		v8::Local<v8::Context> ctx = context();
+		v8::TryCatch tryCatch(m_isolate);
+
+		std::vector<BatchCallError> errors;
+		v8::Local<v8::Value> argv[sizeof...(Args) + 1];
+		std::size_t index = 0;
+
+		for(auto& receiver: receivers) {
+			v8::HandleScope iterationScope(m_isolate);
+			v8::Local<v8::Object> self = internal::BatchReceiver(this, receiver);
+			std::size_t i = index++;
+
+			if (self.IsEmpty()) {
+				errors.push_back(BatchCallError{ i, "Empty receiver" });
+				continue;
+			}
+
+			v8::Local<v8::Value> f = (methodName != nullptr) ? findMethod(self, methodName) : func;
+			if (f.IsEmpty() || !f->IsFunction()) {
+				errors.push_back(BatchCallError{ i, "Not a function" });
+				continue;
+			}
+
+			std::tuple<Args...> args = argsProvider(i);
+			internal::MapTupleArgs(this, argv, args);
+
+			v8::Local<v8::Value> result;
+			if (v8::Local<v8::Function>::Cast(f)->Call(ctx, self, sizeof...(Args), argv).ToLocal(&result)) continue;
+
+			// terminated execution - remaining receivers are not called, termination is left pending
+			if (tryCatch.HasTerminated() || !tryCatch.CanContinue()) {
+				errors.push_back(BatchCallError{ i, "Execution terminated" });
+				break;
+			}
+			errors.push_back(BatchCallError{ i, tryCatch.HasCaught() ? describeException(tryCatch) : std::string("Call failed") });
+			tryCatch.Reset();
+		}
+
+		return errors;
+	}
+
 	// ************************************************************************************
 	template<typename RET, typename... Args>
 	std::function<RET(Args...)> Engine::compileFunction(const std::string& sOrigin, const std::string& func) {
 		ScriptingScope scope(this);
+		invalidateMethodCache();
 
 		v8::ScriptOrigin origin(newString(sOrigin));
 		v8::Local<v8::Script> script;
@@ -818,7 +1276,7 @@ namespace scripting {
 				scope.checkThrowException();
 
 				if (!result.IsEmpty() && result->IsFunction()) {
-					functions::ScriptFunctionCallerPtr caller(new functions::ScriptFunctionCaller(this, result));
+					functions::ScriptFunctionCallerPtr caller = getFunctionCaller(result);
 					return functions::ScriptFunctionCallerExecutor<RET,Args...>(caller);
 				} else {
 					return nullptr;
@@ -29,7 +29,14 @@
 #define INCLUDE_SCRIPTING_FUNCTIONWRAPPER_H_
 
 #include <v8.h>
+#include <algorithm>
 #include <functional>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace scripting {
 	class Engine;
@@ -55,7 +62,7 @@ namespace scripting { namespace functions {
 				}
 
 				std::tuple<typename stdext::remove_const_ref<Args>::type...> argsTuple = internal::UnmapArgs<typename stdext::remove_const_ref<Args>::type...>(engine, args);
-				args.GetReturnValue().Set(internal::CallClassFunctionFromTupleMapReturn<RET>(engine, &func, method, argsTuple));
+				internal::SetReturnValue(args, internal::CallClassFunctionFromTupleMapReturn<RET>(engine, &func, method, argsTuple));
 			};
 		}
 	}
@@ -88,14 +95,12 @@ namespace scripting { namespace functions {
 
 				CLS* instance = ScriptableObject::unwrap<CLS>(args.This());
 				if (instance == nullptr) {
-					engine->throwException(stdext::format("Could not unwrap object for calling %s", funcName));
+					engine->throwException("Could not unwrap object for calling " + funcName);
 					return;
 				}
 
-				std::tuple<typename stdext::remove_const_ref<Args>::type...> tmpTuple = internal::UnmapArgs<typename stdext::remove_const_ref<Args>::type...>(engine, args);
-				std::tuple<CLS*, typename stdext::remove_const_ref<Args>::type...> argsTuple = std::tuple_cat(std::make_tuple(instance), tmpTuple);
-
-				args.GetReturnValue().Set(internal::CallClassFunctionFromTupleMapReturn<RET>(engine, &func, method, argsTuple));
+				std::tuple<typename stdext::remove_const_ref<Args>::type...> argsTuple = internal::UnmapArgs<typename stdext::remove_const_ref<Args>::type...>(engine, args);
+				internal::SetReturnValue(args, internal::CallClassFunctionFromTupleMapReturn<RET>(engine, &func, method, argsTuple, instance));
 			};
 		}
 	}
@@ -110,7 +115,7 @@ namespace scripting { namespace functions {
 	ScriptFunctor makeClassMember(RET(CLS::*func)(Args...)) {
 		auto mf = std::mem_fn(func);
 		auto l = [=](CLS* inst, Args... args) {
-			return mf(inst, args...);
+			return mf(inst, std::forward<Args>(args)...);
 		};
 		return makeClassMember<CLS>(l);
 	}
@@ -119,11 +124,246 @@ namespace scripting { namespace functions {
 	ScriptFunctor makeClassMember(RET(CLS::*func)(Args...) const) {
 		auto mf = std::mem_fn(func);
 		auto l = [=](CLS* inst, Args... args) {
-			return mf(inst, args...);
+			return mf(inst, std::forward<Args>(args)...);
 		};
 		return makeClassMember<CLS>(l);
 	}
 
+	// ******************************************************************************************************************************
+	// class.member overloads
+	// ******************************************************************************************************************************
+
+	namespace impl {
+		// cheap type test of single argument, without conversion
+		// 0 - not accepted, higher value - better match
+		template<typename T, typename = void>
+		struct ArgMatcher {
+			static int score(v8::Local<v8::Value> v) { return 1; }
+		};
+
+		template<>
+		struct ArgMatcher<bool> {
+			static int score(v8::Local<v8::Value> v) { return v->IsBoolean() ? 3 : 0; }
+		};
+
+		template<typename T>
+		struct ArgMatcher<T, typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type> {
+			static int score(v8::Local<v8::Value> v) {
+				if (v->IsInt32()) return 3;
+				return v->IsNumber() ? 1 : 0;
+			}
+		};
+
+		template<typename T>
+		struct ArgMatcher<T, typename std::enable_if<std::is_floating_point<T>::value>::type> {
+			static int score(v8::Local<v8::Value> v) { return v->IsNumber() ? 2 : 0; }
+		};
+
+		template<>
+		struct ArgMatcher<std::string> {
+			static int score(v8::Local<v8::Value> v) { return v->IsString() ? 3 : 0; }
+		};
+
+		template<typename T>
+		struct ArgMatcher<stdext::object_ptr<T>> {
+			static int score(v8::Local<v8::Value> v) {
+				if (v->IsNullOrUndefined()) return 1;
+
+				auto ptr = ScriptableObject::scriptingWrapperSlot(v);
+				if (ptr == nullptr) return 0;
+				return dynamic_cast<T*>(ptr->get()) != nullptr ? 3 : 0;
+			}
+		};
+
+		// parameter T bound to script argument INDEX (same mapping as UnmapArgs); ReturnSlot takes
+		// no argument and ArgsView takes any number of them, so both match anything
+		template<typename T, int INDEX>
+		struct ParamMatcher {
+			static int score(const v8::FunctionCallbackInfo<v8::Value>& args) {
+				if (!internal::impl::ArgUnmapper<T>::consumesArg || std::is_same<T, ArgsView>::value) return 1;
+				return (INDEX < args.Length()) ? ArgMatcher<T>::score(args[INDEX]) : 1;
+			}
+		};
+
+		template<typename... Args>
+		struct HasArgsView {
+			static const bool value = false;
+		};
+
+		template<typename T, typename... Args>
+		struct HasArgsView<T, Args...> {
+			static const bool value = std::is_same<T, ArgsView>::value || HasArgsView<Args...>::value;
+		};
+
+		// number of fixed script arguments of signature
+		template<typename... Args>
+		struct OverloadArity {
+			static const bool variadic = HasArgsView<Args...>::value;
+			static const int value = internal::impl::ScriptArgIndex<sizeof...(Args), Args...>::value - (variadic ? 1 : 0);
+		};
+
+		template<typename... Args>
+		struct OverloadSignature {
+			static int score(const v8::FunctionCallbackInfo<v8::Value>& args) {
+				return scoreInternal(args, stdext::make_index_sequence<sizeof...(Args)>());
+			}
+
+			// arguments missing in call are default filled, so they match anything
+			template<std::size_t... I>
+			static int scoreInternal(const v8::FunctionCallbackInfo<v8::Value>& args, stdext::index_sequence<I...>) {
+				int scores[] = { 1, ParamMatcher<Args, internal::impl::ScriptArgIndex<(int)I, Args...>::value>::score(args)... };
+
+				int total = 0;
+				for(int s: scores) {
+					if (s == 0) return 0;
+					total += s;
+				}
+				return total;
+			}
+		};
+	}
+
+	namespace impl {
+		// member function as callable taking instance first, like lambdas given to makeClassMember
+		template<typename CLS, typename M>
+		struct MemberCallable;
+
+		template<typename CLS, typename MC, typename RET, typename... Args>
+		struct MemberCallable<CLS, RET(MC::*)(Args...)> {
+			RET(MC::*func)(Args...);
+			RET operator()(CLS* inst, Args... args) const { return (inst->*func)(std::forward<Args>(args)...); }
+		};
+
+		template<typename CLS, typename MC, typename RET, typename... Args>
+		struct MemberCallable<CLS, RET(MC::*)(Args...) const> {
+			RET(MC::*func)(Args...) const;
+			RET operator()(CLS* inst, Args... args) const { return (inst->*func)(std::forward<Args>(args)...); }
+		};
+
+		template<typename CLS, typename F, typename = void>
+		struct ClassCallable {
+			typedef F type;
+			static const F& make(const F& f) { return f; }
+		};
+
+		template<typename CLS, typename F>
+		struct ClassCallable<CLS, F, typename std::enable_if<std::is_member_function_pointer<F>::value>::type> {
+			typedef MemberCallable<CLS, F> type;
+			static type make(F f) {
+				type res;
+				res.func = f;
+				return res;
+			}
+		};
+
+		// one overload - arity, scorer and call are resolved at compile time from signature
+		template<typename CLS, typename F, typename M = decltype(&F::operator())>
+		struct OverloadThunk;
+
+		template<typename CLS, typename F, typename RET, typename... Args>
+		struct OverloadThunk<CLS, F, RET(F::*)(CLS*, Args...) const> {
+			typedef OverloadSignature<typename stdext::remove_const_ref<Args>::type...> Signature;
+			typedef OverloadArity<typename stdext::remove_const_ref<Args>::type...> Arity;
+
+			static void call(const F& func, Engine* engine, CLS* instance, const v8::FunctionCallbackInfo<v8::Value>& args) {
+				std::tuple<typename stdext::remove_const_ref<Args>::type...> argsTuple = internal::UnmapArgs<typename stdext::remove_const_ref<Args>::type...>(engine, args);
+				internal::SetReturnValue(args, internal::CallClassFunctionFromTupleMapReturn<RET>(engine, &func, &F::operator(), argsTuple, instance));
+			}
+		};
+
+		// Dispatch table built from overload pack. Call goes to best scored overload of exact
+		// arity, or of nearest greater arity (missing arguments default filled); then to variadic
+		// (ArgsView) ones; then to largest arity below argument count (extra arguments ignored,
+		// as by single signature bindings)
+		template<typename CLS, typename... F>
+		class OverloadSet {
+			public:
+				OverloadSet(const F&... funcs) : m_funcs(funcs...) { }
+
+				void operator()(Engine* engine, const std::string& funcName, const v8::FunctionCallbackInfo<v8::Value>& args) const {
+					if (args.IsConstructCall()) {
+						engine->throwException(stdext::format("Could not call function %s in ctor context", funcName));
+						return;
+					}
+
+					CLS* instance = ScriptableObject::unwrap<CLS>(args.This());
+					if (instance == nullptr) {
+						engine->throwException("Could not unwrap object for calling " + funcName);
+						return;
+					}
+
+					dispatch(engine, funcName, instance, args, stdext::make_index_sequence<sizeof...(F)>());
+				}
+
+			private:
+				typedef void (*CallFn)(const OverloadSet* self, Engine* engine, CLS* instance, const v8::FunctionCallbackInfo<v8::Value>& args);
+				typedef int (*ScoreFn)(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+				std::tuple<F...> m_funcs;
+
+				template<std::size_t I>
+				static void callAt(const OverloadSet* self, Engine* engine, CLS* instance, const v8::FunctionCallbackInfo<v8::Value>& args) {
+					typedef typename std::tuple_element<I, std::tuple<F...>>::type FI;
+					OverloadThunk<CLS, FI>::call(std::get<I>(self->m_funcs), engine, instance, args);
+				}
+
+				template<std::size_t... I>
+				void dispatch(Engine* engine, const std::string& funcName, CLS* instance, const v8::FunctionCallbackInfo<v8::Value>& args, stdext::index_sequence<I...>) const {
+					static const int arity[] = { OverloadThunk<CLS, F>::Arity::value... };
+					static const bool variadic[] = { OverloadThunk<CLS, F>::Arity::variadic... };
+					static const ScoreFn score[] = { &OverloadThunk<CLS, F>::Signature::score... };
+					static const CallFn call[] = { &OverloadSet::template callAt<I>... };
+					static const std::size_t count = sizeof...(F);
+
+					int argc = args.Length();
+					int best = bestOf(args, arity, variadic, score, count, [argc](int a, bool v) { return !v && a >= argc; }, true);
+					if (best < 0) best = bestOf(args, arity, variadic, score, count, [](int a, bool v) { return v; }, false);
+					if (best < 0) best = bestOf(args, arity, variadic, score, count, [argc](int a, bool v) { return !v && a < argc; }, false);
+
+					if (best < 0) {
+						engine->throwException("No overload of " + funcName + " matches given arguments");
+						return;
+					}
+					call[best](this, engine, instance, args);
+				}
+
+				// best scored among candidates of one arity - lowest (or highest) one of accepted
+				template<typename ACCEPT>
+				static int bestOf(const v8::FunctionCallbackInfo<v8::Value>& args, const int* arity, const bool* variadic, const ScoreFn* score, std::size_t count, ACCEPT accept, bool lowestArity) {
+					int target = -1;
+					for(std::size_t i=0;i<count;++i) {
+						if (!accept(arity[i], variadic[i])) continue;
+						if (target < 0 || (lowestArity ? arity[i] < target : arity[i] > target)) target = arity[i];
+					}
+					if (target < 0) return -1;
+
+					int best = -1;
+					int bestScore = 0;
+					for(std::size_t i=0;i<count;++i) {
+						if (!accept(arity[i], variadic[i]) || (!variadic[i] && arity[i] != target)) continue;
+
+						int s = score[i](args);
+						if (s > bestScore) {
+							best = (int)i;
+							bestScore = s;
+						}
+					}
+					return best;
+				}
+		};
+
+		template<typename CLS, typename... F>
+		OverloadSet<CLS, typename ClassCallable<CLS, F>::type...> makeOverloadSet(const F&... funcs) {
+			return OverloadSet<CLS, typename ClassCallable<CLS, F>::type...>(ClassCallable<CLS, F>::make(funcs)...);
+		}
+	}
+
+	// overloads of class member - lambdas taking CLS* first or member functions
+	template<typename CLS, typename... F>
+	ScriptFunctor makeOverloaded(const F&... funcs) {
+		return impl::makeOverloadSet<CLS>(funcs...);
+	}
+
 	// ******************************************************************************************************************************
 	// singleton.member
 	// ******************************************************************************************************************************
@@ -132,7 +372,7 @@ namespace scripting { namespace functions {
 	ScriptFunctor makeSingletonMember(CLS* inst, RET(CLS::*func)(Args...)) {
 		auto mf = std::mem_fn(func);
 		auto l = [=](Args... args) {
-			return mf(inst, args...);
+			return mf(inst, std::forward<Args>(args)...);
 		};
 		return makeStatic(l);
 	}
@@ -141,12 +381,262 @@ namespace scripting { namespace functions {
 	ScriptFunctor makeSingletonMember(CLS* inst, RET(CLS::*func)(Args...) const) {
 		auto mf = std::mem_fn(func);
 		auto l = [=](Args... args) {
-			return mf(inst, args...);
+			return mf(inst, std::forward<Args>(args)...);
 		};
 		return makeStatic(l);
 	}
 
 
+	// ******************************************************************************************************************************
+	// class.accessor
+	// ******************************************************************************************************************************
+
+	namespace impl {
+		template<typename CLS, typename RET>
+		RET invokeGetter(CLS* inst, RET(CLS::*func)()) {
+			return (inst->*func)();
+		}
+
+		template<typename CLS, typename RET>
+		RET invokeGetter(CLS* inst, RET(CLS::*func)() const) {
+			return (inst->*func)();
+		}
+
+		template<typename CLS, typename F>
+		auto invokeGetter(CLS* inst, const F& func) -> decltype(func(inst)) {
+			return func(inst);
+		}
+
+		template<typename CLS, typename RET, typename T>
+		void invokeSetter(Engine* engine, CLS* inst, RET(CLS::*func)(T), v8::Local<v8::Value> value) {
+			(inst->*func)(converters::ConverterHelper<typename stdext::remove_const_ref<T>::type>::from(engine, value));
+		}
+
+		template<typename CLS, typename F, typename RET, typename T>
+		void invokeSetterInternal(Engine* engine, CLS* inst, const F& func, RET(F::*method)(CLS*, T) const, v8::Local<v8::Value> value) {
+			func(inst, converters::ConverterHelper<typename stdext::remove_const_ref<T>::type>::from(engine, value));
+		}
+
+		template<typename CLS, typename F>
+		void invokeSetter(Engine* engine, CLS* inst, const F& func, v8::Local<v8::Value> value) {
+			invokeSetterInternal<CLS,F>(engine, inst, func, &F::operator(), value);
+		}
+
+		// instance wrapped by ScriptableObject
+		struct ScriptableInstance {
+			template<typename CLS, typename INFO>
+			static CLS* get(const INFO& info) { return ScriptableObject::unwrap<CLS>(info.This()); }
+		};
+
+		// instance pointer kept directly in internal field of native singleton
+		struct SingletonInstance {
+			template<typename CLS, typename INFO>
+			static CLS* get(const INFO& info) { return static_cast<CLS*>(info.Holder()->GetAlignedPointerFromInternalField(0)); }
+		};
+	}
+
+	class AccessorHolderBase {
+		public:
+			Engine* engine;
+			std::string name;
+
+			AccessorHolderBase(Engine* engine, const std::string& name) : engine(engine), name(name) { }
+			virtual ~AccessorHolderBase() { }
+	};
+
+	// getter/setter are called directly from v8 accessor callbacks, without intermediate JS function
+	template<typename CLS, typename GETTER, typename INSTANCE = impl::ScriptableInstance>
+	class GetterHolder: public AccessorHolderBase {
+		public:
+			GETTER getter;
+
+			GetterHolder(Engine* engine, const std::string& name, const GETTER& getter) : AccessorHolderBase(engine, name), getter(getter) { }
+
+			static void Getter(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value>& info) {
+				GetterHolder* holder = static_cast<GetterHolder*>((AccessorHolderBase*)v8::Local<v8::External>::Cast(info.Data())->Value());
+
+				CLS* instance = INSTANCE::template get<CLS>(info);
+				if (instance == nullptr) {
+					holder->engine->throwException("Could not unwrap object for getting " + holder->name);
+					return;
+				}
+
+				info.GetReturnValue().Set(converters::convertTo(holder->engine, impl::invokeGetter(instance, holder->getter)));
+			}
+	};
+
+	template<typename CLS, typename GETTER, typename SETTER, typename INSTANCE = impl::ScriptableInstance>
+	class AccessorHolder: public GetterHolder<CLS,GETTER,INSTANCE> {
+		public:
+			SETTER setter;
+
+			AccessorHolder(Engine* engine, const std::string& name, const GETTER& getter, const SETTER& setter) : GetterHolder<CLS,GETTER,INSTANCE>(engine, name, getter), setter(setter) { }
+
+			static void Setter(v8::Local<v8::Name> property, v8::Local<v8::Value> value, const v8::PropertyCallbackInfo<void>& info) {
+				AccessorHolder* holder = static_cast<AccessorHolder*>((AccessorHolderBase*)v8::Local<v8::External>::Cast(info.Data())->Value());
+
+				CLS* instance = INSTANCE::template get<CLS>(info);
+				if (instance == nullptr) {
+					holder->engine->throwException("Could not unwrap object for setting " + holder->name);
+					return;
+				}
+
+				impl::invokeSetter<CLS>(holder->engine, instance, holder->setter, value);
+			}
+	};
+
+	// ******************************************************************************************************************************
+	// class.field
+	// ******************************************************************************************************************************
+
+	// data member read/written in place through the unwrapped instance
+	template<typename CLS, typename OWNER, typename M, typename INSTANCE = impl::ScriptableInstance>
+	class FieldHolder: public AccessorHolderBase {
+		public:
+			M OWNER::*member;
+
+			FieldHolder(Engine* engine, const std::string& name, M OWNER::*member) : AccessorHolderBase(engine, name), member(member) { }
+
+			static void Getter(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value>& info) {
+				FieldHolder* holder = static_cast<FieldHolder*>((AccessorHolderBase*)v8::Local<v8::External>::Cast(info.Data())->Value());
+
+				CLS* instance = INSTANCE::template get<CLS>(info);
+				if (instance == nullptr) {
+					holder->engine->throwException("Could not unwrap object for getting " + holder->name);
+					return;
+				}
+
+				info.GetReturnValue().Set(converters::convertTo(holder->engine, instance->*(holder->member)));
+			}
+
+			static void Setter(v8::Local<v8::Name> property, v8::Local<v8::Value> value, const v8::PropertyCallbackInfo<void>& info) {
+				FieldHolder* holder = static_cast<FieldHolder*>((AccessorHolderBase*)v8::Local<v8::External>::Cast(info.Data())->Value());
+
+				CLS* instance = INSTANCE::template get<CLS>(info);
+				if (instance == nullptr) {
+					holder->engine->throwException("Could not unwrap object for setting " + holder->name);
+					return;
+				}
+
+				converters::convertFrom(holder->engine, value, instance->*(holder->member));
+			}
+	};
+
+	// ******************************************************************************************************************************
+	// native singleton
+	// ******************************************************************************************************************************
+
+	template<typename CLS, typename F, typename RET, typename... Args>
+	class SingletonMethodHolder: public AccessorHolderBase {
+		public:
+			F method;
+
+			SingletonMethodHolder(Engine* engine, const std::string& name, F method) : AccessorHolderBase(engine, name), method(method) { }
+
+			static void Call(const v8::FunctionCallbackInfo<v8::Value>& args) {
+				SingletonMethodHolder* holder = static_cast<SingletonMethodHolder*>((AccessorHolderBase*)v8::Local<v8::External>::Cast(args.Data())->Value());
+				if (args.IsConstructCall()) {
+					holder->engine->throwException(stdext::format("Could not call function %s in ctor context", holder->name));
+					return;
+				}
+
+				CLS* instance = impl::SingletonInstance::get<CLS>(args);
+				std::tuple<typename stdext::remove_const_ref<Args>::type...> argsTuple = internal::UnmapArgs<typename stdext::remove_const_ref<Args>::type...>(holder->engine, args);
+				internal::SetReturnValue(args, internal::CallClassFunctionFromTupleMapReturn<RET>(holder->engine, instance, holder->method, argsTuple));
+			}
+	};
+
+	struct NativeSingletonEntry {
+		std::string name;
+		AccessorHolderBase* holder;
+		v8::FunctionCallback method;
+		v8::AccessorNameGetterCallback getter;
+		v8::AccessorNameSetterCallback setter;
+	};
+
+	// declares singleton methods/accessors, which are put on ObjectTemplate by install()
+	template<typename CLS>
+	class NativeSingletonTemplate {
+		public:
+			NativeSingletonTemplate(Engine* engine, const std::string& name, CLS* instance) : m_engine(engine), m_name(name), m_instance(instance) { }
+			NativeSingletonTemplate(NativeSingletonTemplate&& other) : m_engine(other.m_engine), m_name(std::move(other.m_name)), m_instance(other.m_instance), m_entries(std::move(other.m_entries)) {
+				other.m_entries.clear();
+			}
+			~NativeSingletonTemplate() {
+				for(auto& entry: m_entries) delete entry.holder;
+			}
+
+			template<typename RET, typename... Args>
+			NativeSingletonTemplate& method(const std::string& name, RET(CLS::*func)(Args...)) {
+				typedef SingletonMethodHolder<CLS, RET(CLS::*)(Args...), RET, Args...> Holder;
+				return add(name, new Holder(m_engine, holderName(name), func), &Holder::Call, nullptr, nullptr);
+			}
+
+			template<typename RET, typename... Args>
+			NativeSingletonTemplate& method(const std::string& name, RET(CLS::*func)(Args...) const) {
+				typedef SingletonMethodHolder<CLS, RET(CLS::*)(Args...) const, RET, Args...> Holder;
+				return add(name, new Holder(m_engine, holderName(name), func), &Holder::Call, nullptr, nullptr);
+			}
+
+			template<typename GETTER>
+			NativeSingletonTemplate& accessor(const std::string& name, const GETTER& getter) {
+				typedef GetterHolder<CLS, GETTER, impl::SingletonInstance> Holder;
+				return add(name, new Holder(m_engine, holderName(name), getter), nullptr, &Holder::Getter, nullptr);
+			}
+
+			template<typename GETTER, typename SETTER>
+			NativeSingletonTemplate& accessor(const std::string& name, const GETTER& getter, const SETTER& setter) {
+				typedef AccessorHolder<CLS, GETTER, SETTER, impl::SingletonInstance> Holder;
+				return add(name, new Holder(m_engine, holderName(name), getter, setter), nullptr, &Holder::Getter, &Holder::Setter);
+			}
+
+			template<typename OWNER, typename M>
+			NativeSingletonTemplate& field(const std::string& name, M OWNER::*member) {
+				static_assert(std::is_base_of<OWNER, CLS>::value, "field must be member of class or its base");
+				static_assert(!std::is_const<M>::value, "const field can be registered only as read only");
+
+				typedef FieldHolder<CLS, OWNER, M, impl::SingletonInstance> Holder;
+				return add(name, new Holder(m_engine, holderName(name), member), nullptr, &Holder::Getter, &Holder::Setter);
+			}
+
+			template<typename OWNER, typename M>
+			NativeSingletonTemplate& readOnlyField(const std::string& name, M OWNER::*member) {
+				static_assert(std::is_base_of<OWNER, CLS>::value, "field must be member of class or its base");
+
+				typedef FieldHolder<CLS, OWNER, M, impl::SingletonInstance> Holder;
+				return add(name, new Holder(m_engine, holderName(name), member), nullptr, &Holder::Getter, nullptr);
+			}
+
+			void install();
+
+		private:
+			NativeSingletonTemplate(const NativeSingletonTemplate& from);
+			NativeSingletonTemplate& operator=(const NativeSingletonTemplate& a);
+
+			Engine* m_engine;
+			std::string m_name;
+			CLS* m_instance;
+			std::vector<NativeSingletonEntry> m_entries;
+
+			std::string holderName(const std::string& name) const { return stdext::format("%s.%s", m_name, name); }
+
+			NativeSingletonTemplate& add(const std::string& name, AccessorHolderBase* holder, v8::FunctionCallback method, v8::AccessorNameGetterCallback getter, v8::AccessorNameSetterCallback setter) {
+				NativeSingletonEntry entry;
+				entry.name = name;
+				entry.holder = holder;
+				entry.method = method;
+				entry.getter = getter;
+				entry.setter = setter;
+				m_entries.push_back(entry);
+				return *this;
+			}
+	};
+
+	template<typename CLS>
+	void NativeSingletonTemplate<CLS>::install() {
+		m_engine->installNativeSingleton(m_name, m_instance, m_entries);
+	}
+
 	// **************************************************************************************************
 	// ScriptFunctorHolder
 	// **************************************************************************************************
@@ -154,11 +644,16 @@ namespace scripting { namespace functions {
 	class ScriptFunctorHolder {
 		public:
 			Engine* engine;
-			std::string name;
+			const std::string* name;		// interned in engine binding arena, or ownName
 			v8::Persistent<v8::Function> funcPersistent;
 			ScriptFunctor functor;
+			int64_t externalSize;
+			std::string ownName;
 
-			ScriptFunctorHolder(Engine* engine, const std::string& name, const ScriptFunctor& functor) : engine(engine), name(name), functor(functor) {
+			ScriptFunctorHolder(Engine* engine, const std::string* name, const ScriptFunctor& functor) : engine(engine), name(name), functor(functor), externalSize(0) {
+
+			}
+			ScriptFunctorHolder(Engine* engine, const std::string& ownName, const ScriptFunctor& functor) : engine(engine), name(&this->ownName), functor(functor), externalSize(0), ownName(ownName) {
 
 			}
 			~ScriptFunctorHolder() {
@@ -166,7 +661,7 @@ namespace scripting { namespace functions {
 			}
 
 			void call(const v8::FunctionCallbackInfo<v8::Value>& args) {
-				functor(engine, name, args);
+				functor(engine, *name, args);
 			}
 	};
 
@@ -177,47 +672,112 @@ namespace scripting { namespace functions {
 	class ScriptFunctionCaller;
 	typedef stdext::object_ptr<ScriptFunctionCaller> ScriptFunctionCallerPtr;
 
+	// callers shared per function identity. Owned together by engine and its callers, as
+	// std::function holding caller can be dropped on any thread and also after engine is gone.
+	// Script exceptions keep their handles alive the same way
+	struct FunctionCallerRegistry {
+		std::mutex mutex;
+		bool alive;
+		std::unordered_multimap<int, ScriptFunctionCaller*> callers;
+		std::unordered_set<internal::ScriptExceptionState*> exceptions;
+		std::vector<v8::Global<v8::Function>> released;			// reset by engine under isolate lock
+		std::vector<v8::Global<v8::Value>> releasedValues;
+		std::vector<v8::Global<v8::Message>> releasedMessages;
+
+		FunctionCallerRegistry() : alive(true) { }
+	};
+
 	class ScriptFunctionCaller: public stdext::object {
 		public:
-			v8::Persistent<v8::Function> func;
+			v8::Global<v8::Function> func;
 			Engine* engine;
+			std::shared_ptr<FunctionCallerRegistry> registry;		// set when registered
+			int identityHash;
 
-			ScriptFunctionCaller(Engine* engine, v8::Local<v8::Value> f) {
+			ScriptFunctionCaller(Engine* engine, v8::Local<v8::Value> f) : m_refs(0) {
 				this->engine = engine;
+				this->identityHash = 0;
 
 				if (!f.IsEmpty() && f->IsFunction()) {
 					func.Reset(engine->isolate(), v8::Local<v8::Function>::Cast(f));
 				}
 			}
 
-			virtual ~ScriptFunctionCaller() {
-				func.Reset();
+			// references are atomic, as std::function holding caller can be copied and dropped
+			// on any thread. Last one is dropped under registry mutex together with unregistering,
+			// so engine lookup never hands out caller being destroyed
+			virtual void __refsInc() {
+				m_refs.fetch_add(1);
+			}
+
+			virtual void __refsDec() {
+				int32_t n = m_refs.load();
+				while(n > 1) {
+					if (m_refs.compare_exchange_weak(n, n - 1)) return;
+				}
+
+				if (registry) {
+					std::lock_guard<std::mutex> lock(registry->mutex);
+					if (m_refs.fetch_sub(1) != 1) return;
+					unregister();
+				} else {
+					if (m_refs.fetch_sub(1) != 1) return;
+				}
+				delete this;
+			}
+
+			// called by engine under registry mutex
+			bool tryRef() {
+				int32_t n = m_refs.load();
+				while(n > 0) {
+					if (m_refs.compare_exchange_weak(n, n + 1)) return true;
+				}
+				return false;
+			}
+			// drops reference taken by tryRef while other one is held, never the last
+			void releaseRef() {
+				m_refs.fetch_sub(1);
 			}
 
+			// called with undefined receiver, so no object is allocated per call
 			template<typename R, typename... Args>
-			R callReturn(Args... args) {
+			R callReturn(const Args&... args) {
 				if (func.IsEmpty()) {
 					return R();
 				} else {
 					ScriptingScope scope(engine);
-					v8::Local<v8::Object> self = engine->newAnonymousObject();
-
-					R res = engine->CallScriptFunction<R>(func.Get(engine->isolate()), self, args...);
+					R res = engine->CallScriptFunction<R>(func.Get(engine->isolate()), engine->newUndefined(), args...);
 					scope.checkThrowException();
 					return res;
 				}
 			}
 
 			template<typename... Args>
-			void callVoid(Args... args) {
+			void callVoid(const Args&... args) {
 				if (func.IsEmpty()) return;
 
 				ScriptingScope scope(engine);
-				v8::Local<v8::Object> self = engine->newAnonymousObject();
-
-				engine->CallScriptFunction<void>(func.Get(engine->isolate()), self, args...);
+				engine->CallScriptFunction<void>(func.Get(engine->isolate()), engine->newUndefined(), args...);
 				scope.checkThrowException();
 			}
+
+		private:
+			std::atomic<int32_t> m_refs;
+
+			// handle is not reset here (no isolate lock), engine does it later; after
+			// engine shutdown func is already empty
+			void unregister() {
+				if (!registry->alive) return;
+
+				auto range = registry->callers.equal_range(identityHash);
+				for(auto it = range.first; it != range.second; ++it) {
+					if (it->second == this) {
+						registry->callers.erase(it);
+						break;
+					}
+				}
+				if (!func.IsEmpty()) registry->released.push_back(std::move(func));
+			}
 	};
 
 	template<typename R, typename... Args>
@@ -228,7 +788,7 @@ namespace scripting { namespace functions {
 			ScriptFunctionCallerExecutor(ScriptFunctionCallerPtr caller) : caller(caller) { }
 
 			R operator()(Args... args) {
-				return caller->callReturn<R, Args...>(args...);
+				return caller->callReturn<R>(args...);
 			}
 	};
 
@@ -240,7 +800,7 @@ namespace scripting { namespace functions {
 			ScriptFunctionCallerExecutor(ScriptFunctionCallerPtr caller) : caller(caller) { }
 
 			void operator()(Args... args) {
-				caller->callVoid<Args...>(args...);
+				caller->callVoid(args...);
 			}
 	};
 
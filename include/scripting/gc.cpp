@@ -0,0 +1,244 @@
+/*
+ * Copyright (c) preg-v8-binder <https://github.com/pregusia/preg-v8-binder>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "gc.h"
+#include "engine.h"
+#include <v8-platform.h>
+#include <cstdio>
+#include <chrono>
+
+#ifdef __linux__
+#	include <unistd.h>
+#endif
+
+namespace scripting {
+
+	// ************************************************************************************
+	GcPolicy::GcPolicy(Engine* engine) : m_engine(engine), m_level(v8::MemoryPressureLevel::kNone), m_lowMemoryHeapUsed(0) {
+
+	}
+
+	// ************************************************************************************
+	bool GcPolicy::idle(double budgetSeconds) {
+		ScriptingScope scope(m_engine);
+		v8::Isolate* isolate = m_engine->isolate();
+
+		m_engine->flushExternalMemory();
+		checkPressure();
+
+		double deadline = m_engine->platform()->MonotonicallyIncreasingTime() + budgetSeconds;
+		bool done = isolate->IdleNotificationDeadline(deadline);
+
+		// native destructors of objects collected so far get rest of budget
+		double left = deadline - m_engine->platform()->MonotonicallyIncreasingTime();
+		if (!m_engine->finalizationQueue().drain(left)) done = false;
+
+		if (done && m_settings.lowMemoryIdleBudget > 0 && budgetSeconds >= m_settings.lowMemoryIdleBudget) {
+			v8::HeapStatistics stats;
+			isolate->GetHeapStatistics(&stats);
+			if (stats.used_heap_size() >= m_lowMemoryHeapUsed + m_settings.lowMemoryHeapGrowth) {
+				collectAll();
+			}
+		}
+
+		return done;
+	}
+
+	// ************************************************************************************
+	v8::MemoryPressureLevel GcPolicy::checkPressure() {
+		v8::HeapStatistics stats;
+		m_engine->isolate()->GetHeapStatistics(&stats);
+		std::size_t heap = stats.used_heap_size();
+		std::size_t rss = (m_settings.rssModerate > 0 || m_settings.rssCritical > 0) ? residentSize() : 0;
+
+		auto exceeds = [](std::size_t value, std::size_t limit) { return limit > 0 && value >= limit; };
+
+		v8::MemoryPressureLevel level = v8::MemoryPressureLevel::kNone;
+		if (exceeds(heap, m_settings.heapCritical) || exceeds(rss, m_settings.rssCritical)) {
+			level = v8::MemoryPressureLevel::kCritical;
+		} else if (exceeds(heap, m_settings.heapModerate) || exceeds(rss, m_settings.rssModerate)) {
+			level = v8::MemoryPressureLevel::kModerate;
+		}
+
+		if (level != m_level) {
+			m_level = level;
+			m_engine->isolate()->MemoryPressureNotification(level);
+		}
+		return level;
+	}
+
+	// ************************************************************************************
+	void GcPolicy::collectAll() {
+		ScriptingScope scope(m_engine);
+		v8::Isolate* isolate = m_engine->isolate();
+
+		m_engine->flushExternalMemory();
+		isolate->LowMemoryNotification();
+		m_engine->finalizationQueue().drainAll();
+
+		v8::HeapStatistics stats;
+		isolate->GetHeapStatistics(&stats);
+		m_lowMemoryHeapUsed = stats.used_heap_size();
+	}
+
+	// ************************************************************************************
+	std::size_t GcPolicy::residentSize() {
+#ifdef __linux__
+		FILE* f = fopen("/proc/self/statm", "r");
+		if (f == nullptr) return 0;
+
+		unsigned long size = 0;
+		unsigned long resident = 0;
+		int res = fscanf(f, "%lu %lu", &size, &resident);
+		fclose(f);
+
+		if (res != 2) return 0;
+		return (std::size_t)resident * (std::size_t)sysconf(_SC_PAGESIZE);
+#else
+		return 0;
+#endif
+	}
+
+	// ************************************************************************************
+	FinalizationQueue::FinalizationQueue() : m_head(nullptr), m_taken(nullptr), m_backgroundHead(nullptr), m_pending(0), m_enginePending(0), m_workerStop(false) {
+
+	}
+
+	// ************************************************************************************
+	FinalizationQueue::~FinalizationQueue() {
+		drainAll();
+
+		if (m_worker.joinable()) {
+			m_workerStop.store(true);
+			m_workerCond.notify_one();
+			m_worker.join();
+		}
+
+		// pushed after last pass of worker
+		Node* node = m_backgroundHead.exchange(nullptr, std::memory_order_acquire);
+		while (node != nullptr) {
+			Node* next = node->next;
+			release(node);
+			node = next;
+		}
+	}
+
+	// ************************************************************************************
+	void FinalizationQueue::push(stdext::object_ptr<ScriptableObject>* ptr) {
+		ScriptableObject* obj = ptr->get();
+
+		// still owned by native code, dropping reference does not destroy anything
+		if (obj == nullptr || obj->__refsCount() > 1) {
+			stdext::pool_delete(ptr);
+			return;
+		}
+
+		Node* node = stdext::pool_new<Node>();
+		node->ptr = ptr;
+		node->next = nullptr;
+		m_pending.fetch_add(1, std::memory_order_relaxed);
+
+		if (obj->scriptingDestroyAnyThread()) {
+			// wrapper was the only owner, after weak references expire nothing else can reach object
+			obj->__weakExpire();
+			if (!m_worker.joinable()) m_worker = std::thread(&FinalizationQueue::workerLoop, this);
+			pushNode(m_backgroundHead, node);
+			m_workerCond.notify_one();
+		} else {
+			m_enginePending.fetch_add(1, std::memory_order_relaxed);
+			pushNode(m_head, node);
+		}
+	}
+
+	// ************************************************************************************
+	bool FinalizationQueue::drain(double budgetSeconds) {
+		// progress is guaranteed even when caller's budget was already used up
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(std::max(budgetSeconds, 0.0)));
+		while (releaseOne()) {
+			if (std::chrono::steady_clock::now() >= deadline) break;
+		}
+		return m_taken == nullptr && m_head.load(std::memory_order_relaxed) == nullptr;
+	}
+
+	// ************************************************************************************
+	void FinalizationQueue::safePoint() {
+		std::size_t backlog = m_enginePending.load(std::memory_order_relaxed);
+		if (backlog == 0) return;
+
+		if (backlog >= SAFE_POINT_BACKLOG) {
+			drainAll();
+		} else {
+			drain(SAFE_POINT_BUDGET);
+		}
+	}
+
+	// ************************************************************************************
+	void FinalizationQueue::drainAll() {
+		while (releaseOne()) { }
+	}
+
+	// ************************************************************************************
+	void FinalizationQueue::pushNode(std::atomic<Node*>& head, Node* node) {
+		node->next = head.load(std::memory_order_relaxed);
+		while (!head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) { }
+	}
+
+	// ************************************************************************************
+	void FinalizationQueue::release(Node* node) {
+		stdext::pool_delete(node->ptr);
+		stdext::pool_delete(node);
+		m_pending.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	// ************************************************************************************
+	bool FinalizationQueue::releaseOne() {
+		// whole list is taken at once, so pops never race with pushes (no ABA)
+		if (m_taken == nullptr) m_taken = m_head.exchange(nullptr, std::memory_order_acquire);
+		if (m_taken == nullptr) return false;
+
+		// unlinked before destructor runs, it may trigger GC which pushes more
+		Node* node = m_taken;
+		m_taken = node->next;
+		m_enginePending.fetch_sub(1, std::memory_order_relaxed);
+		release(node);
+		return true;
+	}
+
+	// ************************************************************************************
+	void FinalizationQueue::workerLoop() {
+		while (true) {
+			Node* node = m_backgroundHead.exchange(nullptr, std::memory_order_acquire);
+			while (node != nullptr) {
+				Node* next = node->next;
+				release(node);
+				node = next;
+			}
+			if (m_workerStop.load()) break;
+
+			// notify in push is not synchronized with mutex (lock-free side), timeout covers missed wakeup
+			std::unique_lock<std::mutex> lock(m_workerMutex);
+			m_workerCond.wait_for(lock, std::chrono::milliseconds(50), [this] { return m_workerStop.load() || m_backgroundHead.load() != nullptr; });
+		}
+	}
+
+} /* namespace scripting */
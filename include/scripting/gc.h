@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) preg-v8-binder <https://github.com/pregusia/preg-v8-binder>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef INCLUDE_SCRIPTING_GC_H_
+#define INCLUDE_SCRIPTING_GC_H_
+
+#include "base.h"
+#include <v8.h>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace scripting {
+
+	class Engine;
+	class ScriptableObject;
+
+	// watermarks in bytes, 0 disables given check
+	struct GcPolicySettings {
+		std::size_t heapModerate;
+		std::size_t heapCritical;
+		std::size_t rssModerate;
+		std::size_t rssCritical;
+
+		// full collection (LowMemoryNotification) when idle budget is at least lowMemoryIdleBudget seconds
+		// and heap grew by lowMemoryHeapGrowth since previous one; budget 0 disables it
+		double lowMemoryIdleBudget;
+		std::size_t lowMemoryHeapGrowth;
+
+		GcPolicySettings() : heapModerate(0), heapCritical(0), rssModerate(0), rssCritical(0), lowMemoryIdleBudget(0), lowMemoryHeapGrowth(16 * 1024 * 1024) { }
+	};
+
+	// Decides when and how much GC work v8 gets. Called by host in its idle time
+	// (e.g. rest of frame), never blocks longer than given budget except for optional
+	// low memory collection.
+	class GcPolicy {
+		public:
+			GcPolicy(Engine* engine);
+
+			const GcPolicySettings& settings() const { return m_settings; }
+			void configure(const GcPolicySettings& settings) { m_settings = settings; }
+
+			// gives v8 idle time until now + budgetSeconds, returns true when v8 has no more idle work
+			bool idle(double budgetSeconds);
+
+			// compares heap/rss with watermarks, v8 is notified only when level changes
+			v8::MemoryPressureLevel checkPressure();
+			v8::MemoryPressureLevel pressureLevel() const { return m_level; }
+
+			// full blocking collection
+			void collectAll();
+
+			// resident set size of process (linux only), 0 when not available
+			static std::size_t residentSize();
+
+		private:
+			Engine* m_engine;
+			GcPolicySettings m_settings;
+			v8::MemoryPressureLevel m_level;
+			std::size_t m_lowMemoryHeapUsed;
+	};
+
+	// References released by GC weak callbacks. Instead of running destructors inside
+	// GC pause, callbacks only push here (lock-free); engine thread drops them in idle
+	// time and when outermost ScriptingScope ends, classes with scriptingDestroyAnyThread()
+	// (which own no shared object_ptr, see ScriptableObject) are destroyed by background thread.
+	class FinalizationQueue {
+		public:
+			FinalizationQueue();
+			~FinalizationQueue();
+
+			// called from weak callback, takes ownership of ptr
+			void push(stdext::object_ptr<ScriptableObject>* ptr);
+
+			// engine thread - drops queued references until budgetSeconds elapses (always at least
+			// one), returns true when nothing is left
+			bool drain(double budgetSeconds);
+			void drainAll();
+
+			// engine thread, called at end of outermost ScriptingScope - short drain, everything
+			// when backlog grew over SAFE_POINT_BACKLOG
+			void safePoint();
+
+			std::size_t pending() const { return m_pending.load(std::memory_order_relaxed); }
+
+		private:
+			struct Node {
+				stdext::object_ptr<ScriptableObject>* ptr;
+				Node* next;
+			};
+
+			std::atomic<Node*> m_head;
+			Node* m_taken;
+			std::atomic<Node*> m_backgroundHead;
+			std::atomic<std::size_t> m_pending;
+			std::atomic<std::size_t> m_enginePending;
+
+			std::thread m_worker;
+			std::mutex m_workerMutex;
+			std::condition_variable m_workerCond;
+			std::atomic<bool> m_workerStop;
+
+			static constexpr double SAFE_POINT_BUDGET = 0.0005;
+			static const std::size_t SAFE_POINT_BACKLOG = 1024;
+
+			static void pushNode(std::atomic<Node*>& head, Node* node);
+			void release(Node* node);
+			bool releaseOne();
+			void workerLoop();
+	};
+
+} /* namespace scripting */
+
+#endif /* INCLUDE_SCRIPTING_GC_H_ */
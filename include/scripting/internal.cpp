@@ -57,6 +57,44 @@ namespace scripting { namespace internal {
 		return false;
 	}
 
+	// ************************************************************************************
+	bool SetObjectEntry(Engine* engine, v8::Local<v8::Object> obj, v8::Local<v8::Value> key, v8::Local<v8::Value> val) {
+		v8::Local<v8::Context> context = engine->context();
+
+		if (key->IsUint32()) {
+			uint32_t index = 0;
+			if (!key->Uint32Value(context).To(&index)) return false;
+			return obj->CreateDataProperty(context, index, val).FromMaybe(false);
+		} else if (key->IsName()) {
+			return obj->CreateDataProperty(context, v8::Local<v8::Name>::Cast(key), val).FromMaybe(false);
+		} else {
+			v8::Local<v8::String> str;
+			if (!key->ToString(context).ToLocal(&str)) return false;
+			return obj->CreateDataProperty(context, str, val).FromMaybe(false);
+		}
+	}
+
+	// ************************************************************************************
+	uint32_t NextStructTypeId() {
+		static uint32_t counter = 0;
+		return counter++;
+	}
+
+	// ************************************************************************************
+	uint32_t NextEnumTypeId() {
+		static uint32_t counter = 0;
+		return counter++;
+	}
+
+	// ************************************************************************************
+	void SetTemplateConstant(Engine* engine, v8::Local<v8::ObjectTemplate> tpl, const std::string& name, v8::Local<v8::Value> val) {
+		// templates can hold only primitive values
+		if (val.IsEmpty() || !(val->IsNumber() || val->IsString() || val->IsBoolean() || val->IsNull() || val->IsUndefined())) {
+			throw ScriptingException(stdext::format("Constant %s is not a primitive value", name));
+		}
+		tpl->Set(engine->newInternalizedString(name), val, (v8::PropertyAttribute)(v8::ReadOnly | v8::DontDelete));
+	}
+
 	// ************************************************************************************
 	std::string normalizePrototypeName(const std::string& name, const std::string& ns) {
 		if (ns.empty()) {
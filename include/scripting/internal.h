@@ -51,12 +51,48 @@ namespace scripting { namespace internal {
 	// **************************************************************************************************
 
 	namespace impl {
+		// fills single parameter from call arguments, n is index of script argument
+		template<typename T>
+		struct ArgUnmapper {
+			static const bool consumesArg = true;
+			static void apply(Engine* engine, const v8::FunctionCallbackInfo<v8::Value>& args, int n, T& out) {
+				if (n < args.Length()) {
+					converters::convertFrom(engine, args[n], out);
+				}
+			}
+		};
+
+		template<>
+		struct ArgUnmapper<ArgsView> {
+			static const bool consumesArg = true;
+			static void apply(Engine* engine, const v8::FunctionCallbackInfo<v8::Value>& args, int n, ArgsView& out) {
+				out = ArgsView(engine, args, n);
+			}
+		};
+
+		template<>
+		struct ArgUnmapper<ReturnSlot> {
+			static const bool consumesArg = false;
+			static void apply(Engine* engine, const v8::FunctionCallbackInfo<v8::Value>& args, int n, ReturnSlot& out) {
+				out = ReturnSlot(engine, args);
+			}
+		};
+
+		// index of script argument for N-th parameter (ReturnSlot parameters do not take any)
+		template<int N, typename... ArgsT>
+		struct ScriptArgIndex {
+			static const int value = ScriptArgIndex<N-1,ArgsT...>::value + (ArgUnmapper<typename std::tuple_element<N-1, std::tuple<ArgsT...>>::type>::consumesArg ? 1 : 0);
+		};
+		template<typename... ArgsT>
+		struct ScriptArgIndex<0,ArgsT...> {
+			static const int value = 0;
+		};
+
 		template<int N, typename... ArgsT>
 		struct UnmapArgsImpl {
 			static void apply(std::tuple<ArgsT...>& t, Engine* engine, const v8::FunctionCallbackInfo<v8::Value>& args) {
-				if (N >= 0 && N < args.Length()) {
-					converters::convertFrom(engine, args[N], std::get<N>(t));
-				}
+				typedef typename std::tuple_element<N, std::tuple<ArgsT...>>::type T;
+				ArgUnmapper<T>::apply(engine, args, ScriptArgIndex<N,ArgsT...>::value, std::get<N>(t));
 				UnmapArgsImpl<N-1,ArgsT...>::apply(t, engine, args);
 			}
 		};
@@ -87,7 +123,7 @@ namespace scripting { namespace internal {
 			}
 
 			template<typename F, typename... Args>
-			static void apply(Engine* engine, v8::Local<v8::Value>* out, F first, Args... args) {
+			static void apply(Engine* engine, v8::Local<v8::Value>* out, const F& first, const Args&... args) {
 				out[N] = converters::convertTo(engine, first);
 				MapArgsImpl<N + 1>::apply(engine, out, args...);
 			}
@@ -95,106 +131,114 @@ namespace scripting { namespace internal {
 	}
 
 	template<typename... Args>
-	void MapArgs(Engine* engine, v8::Local<v8::Value>* out, Args... args) {
+	void MapArgs(Engine* engine, v8::Local<v8::Value>* out, const Args&... args) {
 		impl::MapArgsImpl<0>::apply(engine, out, args...);
 	}
 
+	namespace impl {
+		template<typename... Args, std::size_t... I>
+		void MapTupleArgsImpl(Engine* engine, v8::Local<v8::Value>* out, const std::tuple<Args...>& t, stdext::index_sequence<I...>) {
+			MapArgs(engine, out, std::get<I>(t)...);
+		}
+	}
+
+	template<typename... Args>
+	void MapTupleArgs(Engine* engine, v8::Local<v8::Value>* out, const std::tuple<Args...>& t) {
+		impl::MapTupleArgsImpl(engine, out, t, stdext::make_index_sequence<sizeof...(Args)>());
+	}
+
 	// **************************************************************************************************
 	// calling from tuple
 	// **************************************************************************************************
 
 	namespace impl {
-		template<int N, typename R>
-		struct CallFunctionFromTupleImpl {
-			template<typename F, typename... ArgsF, typename... ArgsT>
-			static R call(const F& f, const std::tuple<ArgsT...>& t, ArgsF... args) {
-				return CallFunctionFromTupleImpl<N-1, R>::call(f, t, std::get<N-1>(t), args...);
+		// Params are declared parameter types - tuple elements are moved into by-value parameters
+		// and bound directly to reference ones, so no argument is copied on the way
+		template<typename R, typename... Params>
+		struct CallFromTupleImpl {
+			template<typename F, typename Tuple, std::size_t... I>
+			static R function(const F& f, Tuple& t, stdext::index_sequence<I...>) {
+				return f(std::forward<Params>(std::get<I>(t))...);
+			}
+
+			template<typename C, typename M, typename Tuple, std::size_t... I, typename... Lead>
+			static R member(C* inst, M method, Tuple& t, stdext::index_sequence<I...>, Lead... lead) {
+				return (inst->*method)(lead..., std::forward<Params>(std::get<I>(t))...);
 			}
 		};
 
 		template<typename R>
-		struct CallFunctionFromTupleImpl<0,R> {
-			template<typename F, typename... ArgsF, typename... ArgsT>
-			static R call(const F& f, const std::tuple<ArgsT...>& t, ArgsF... args) {
-				return f(args...);
+		struct MapReturnImpl {
+			template<typename... Params, typename F, typename Tuple>
+			static v8::Local<v8::Value> function(Engine* engine, const F& f, Tuple& t) {
+				return converters::convertTo(engine, CallFromTupleImpl<R, Params...>::function(f, t, stdext::make_index_sequence<sizeof...(Params)>()));
 			}
-		};
 
-		template<typename R, typename F, typename... Args>
-		struct CallFunctionFromTupleMapReturn {
-			static v8::Local<v8::Value> call(Engine* engine, const F& f, const std::tuple<Args...>& t, Args... args) {
-				R ret = CallFunctionFromTupleImpl<sizeof...(Args), R>::call(f, t);
-				return converters::convertTo(engine, ret);
+			template<typename... Params, typename C, typename M, typename Tuple, typename... Lead>
+			static v8::Local<v8::Value> member(Engine* engine, C* inst, M method, Tuple& t, Lead... lead) {
+				return converters::convertTo(engine, CallFromTupleImpl<R, Params...>::member(inst, method, t, stdext::make_index_sequence<sizeof...(Params)>(), lead...));
 			}
 		};
 
-		template<typename F, typename... Args>
-		struct CallFunctionFromTupleMapReturn<void, F, Args...> {
-			static v8::Local<v8::Value> call(Engine* engine, const F& f, const std::tuple<Args...>& t, Args... args) {
-				CallFunctionFromTupleImpl<sizeof...(Args), void>::call(f, t);
-				return engine->newUndefined();
+		template<>
+		struct MapReturnImpl<void> {
+			template<typename... Params, typename F, typename Tuple>
+			static v8::Local<v8::Value> function(Engine* engine, const F& f, Tuple& t) {
+				CallFromTupleImpl<void, Params...>::function(f, t, stdext::make_index_sequence<sizeof...(Params)>());
+				return v8::Local<v8::Value>();
+			}
+
+			template<typename... Params, typename C, typename M, typename Tuple, typename... Lead>
+			static v8::Local<v8::Value> member(Engine* engine, C* inst, M method, Tuple& t, Lead... lead) {
+				CallFromTupleImpl<void, Params...>::member(inst, method, t, stdext::make_index_sequence<sizeof...(Params)>(), lead...);
+				return v8::Local<v8::Value>();
 			}
 		};
 	}
 
-	template<typename R, typename F, typename... Args>
-	R CallFunctionFromTuple(const F& f, const std::tuple<Args...>& t) {
-		return impl::CallFunctionFromTupleImpl<sizeof...(Args), R>::call(f, t);
+	// empty value (void function) leaves return value as is - it could be set through ReturnSlot
+	inline void SetReturnValue(const v8::FunctionCallbackInfo<v8::Value>& args, v8::Local<v8::Value> value) {
+		if (!value.IsEmpty()) args.GetReturnValue().Set(value);
 	}
 
-	template<typename R, typename F, typename... Args>
-	v8::Local<v8::Value> CallFunctionFromTupleMapReturn(Engine* engine, const F& f, const std::tuple<Args...>& t) {
-		return impl::CallFunctionFromTupleMapReturn<R, F, Args...>::call(engine, f, t);
+	template<typename R, typename FR, typename... Params, typename... Args>
+	R CallFunctionFromTuple(FR(*f)(Params...), std::tuple<Args...>& t) {
+		return impl::CallFromTupleImpl<R, Params...>::function(f, t, stdext::make_index_sequence<sizeof...(Params)>());
+	}
+
+	template<typename R, typename FR, typename... Params, typename... Args>
+	v8::Local<v8::Value> CallFunctionFromTupleMapReturn(Engine* engine, FR(*f)(Params...), std::tuple<Args...>& t) {
+		return impl::MapReturnImpl<R>::template function<Params...>(engine, f, t);
 	}
 
 	// **************************************************************************************************
 	// calling class from tuple
 	// **************************************************************************************************
 
-	namespace impl {
-		template<int N, typename R>
-		struct CallClassFunctionFromTupleImpl {
-			template<typename C, typename F, typename... ArgsF, typename... ArgsT>
-			static R call(C* inst, const F& f, const std::tuple<ArgsT...>& t, ArgsF... args) {
-				return CallClassFunctionFromTupleImpl<N-1, R>::call(inst, f, t, std::get<N-1>(t), args...);
-			}
-		};
-
-		template<typename R>
-		struct CallClassFunctionFromTupleImpl<0,R> {
-			template<typename C, typename F, typename... ArgsF, typename... ArgsT>
-			static R call(C* inst, const F& f, const std::tuple<ArgsT...>& t, ArgsF... args) {
-				return (inst->*f)(args...);
-			}
-		};
+	template<typename R, typename C, typename MC, typename MR, typename... Params, typename... Args>
+	R CallClassFunctionFromTuple(C* inst, MR(MC::*method)(Params...), std::tuple<Args...>& t) {
+		return impl::CallFromTupleImpl<R, Params...>::member(inst, method, t, stdext::make_index_sequence<sizeof...(Params)>());
+	}
 
-		template<typename R>
-		struct CallClassFunctionFromTupleMapReturn {
-			template<typename C, typename F, typename... Args>
-			static v8::Local<v8::Value> call(Engine* engine, C* inst, const F& f, const std::tuple<Args...>& t) {
-				R ret = CallClassFunctionFromTupleImpl<sizeof...(Args),R>::call(inst, f, t);
-				return converters::convertTo(engine, ret);
-			}
-		};
+	template<typename R, typename C, typename MC, typename MR, typename... Params, typename... Args>
+	R CallClassFunctionFromTuple(C* inst, MR(MC::*method)(Params...) const, std::tuple<Args...>& t) {
+		return impl::CallFromTupleImpl<R, Params...>::member(inst, method, t, stdext::make_index_sequence<sizeof...(Params)>());
+	}
 
-		template<>
-		struct CallClassFunctionFromTupleMapReturn<void> {
-			template<typename C, typename F, typename... Args>
-			static v8::Local<v8::Value> call(Engine* engine, C* inst, const F& f, const std::tuple<Args...>& t) {
-				CallClassFunctionFromTupleImpl<sizeof...(Args),void>::call(inst, f, t);
-				return engine->newUndefined();
-			}
-		};
+	template<typename R, typename C, typename MC, typename MR, typename... Params, typename... Args>
+	v8::Local<v8::Value> CallClassFunctionFromTupleMapReturn(Engine* engine, C* inst, MR(MC::*method)(Params...), std::tuple<Args...>& t) {
+		return impl::MapReturnImpl<R>::template member<Params...>(engine, inst, method, t);
 	}
 
-	template<typename R, typename C, typename F, typename... Args>
-	R CallClassFunctionFromTuple(C* inst, const F& f, const std::tuple<Args...>& t) {
-		return impl::CallClassFunctionFromTupleImpl<sizeof...(Args),R>::call(inst, f, t);
+	template<typename R, typename C, typename MC, typename MR, typename... Params, typename... Args>
+	v8::Local<v8::Value> CallClassFunctionFromTupleMapReturn(Engine* engine, C* inst, MR(MC::*method)(Params...) const, std::tuple<Args...>& t) {
+		return impl::MapReturnImpl<R>::template member<Params...>(engine, inst, method, t);
 	}
 
-	template<typename R, typename C, typename F, typename... Args>
-	v8::Local<v8::Value> CallClassFunctionFromTupleMapReturn(Engine* engine, C* inst, const F& f, const std::tuple<Args...>& t) {
-		return impl::CallClassFunctionFromTupleMapReturn<R>::template call<C,F,Args...>(engine, inst, f, t);
+	// calls method with self as leading argument, followed by arguments from tuple
+	template<typename R, typename C, typename MC, typename MR, typename S, typename... Params, typename... Args>
+	v8::Local<v8::Value> CallClassFunctionFromTupleMapReturn(Engine* engine, C* inst, MR(MC::*method)(S*, Params...) const, std::tuple<Args...>& t, S* self) {
+		return impl::MapReturnImpl<R>::template member<Params...>(engine, inst, method, t, self);
 	}
 
 	// **************************************************************************************************
@@ -206,15 +250,15 @@ namespace scripting { namespace internal {
 			static void apply(Engine* engine, v8::Local<v8::Array>& arr, int n) { }
 
 			template<typename F, typename... Args>
-			static void apply(Engine* engine, v8::Local<v8::Array>& arr, int n, const F& f, Args... args) {
+			static void apply(Engine* engine, v8::Local<v8::Array>& arr, int n, const F& f, const Args&... args) {
 				arr->Set(n, converters::convertTo(engine, f));
-				SetArrayValuesImpl::apply(arr, n + 1, args...);
+				SetArrayValuesImpl::apply(engine, arr, n + 1, args...);
 			}
 		};
 	}
 
 	template<typename... Args>
-	void SetArrayValues(Engine* engine, v8::Local<v8::Array>& arr, Args... args) {
+	void SetArrayValues(Engine* engine, v8::Local<v8::Array>& arr, const Args&... args) {
 		impl::SetArrayValuesImpl::apply(engine, arr, 0, args...);
 	}
 
@@ -228,7 +272,7 @@ namespace scripting { namespace internal {
 
 			}
 			template<typename K, typename V, typename... Args>
-			static void apply(Engine* engine, v8::Local<v8::Object>& obj, const K& k, const V& v, Args... args) {
+			static void apply(Engine* engine, v8::Local<v8::Object>& obj, const K& k, const V& v, const Args&... args) {
 				obj->DefineOwnProperty(
 					engine->context(),
 					engine->newString(k),
@@ -240,10 +284,193 @@ namespace scripting { namespace internal {
 	}
 
 	template<typename... Args>
-	void SetObjectProps(Engine* engine, v8::Local<v8::Object>& obj, Args... args) {
+	void SetObjectProps(Engine* engine, v8::Local<v8::Object>& obj, const Args&... args) {
 		impl::SetObjectPropsImpl::apply(engine, obj, args...);
 	}
 
+	// **************************************************************************************************
+	// bulk conversions
+	// **************************************************************************************************
+
+	// false when entry could not be stored (exception is then pending)
+	bool SetObjectEntry(Engine* engine, v8::Local<v8::Object> obj, v8::Local<v8::Value> key, v8::Local<v8::Value> val);
+
+	// true for values which are (or contains) v8::Local handles - these cannot be converted
+	// inside nested HandleScope, because handles would not outlive it
+	template<typename T> struct holds_local_handles : std::false_type { };
+	template<typename T> struct holds_local_handles<v8::Local<T>> : std::true_type { };
+	template<typename T> struct holds_local_handles<std::vector<T>> : holds_local_handles<T> { };
+	template<typename T> struct holds_local_handles<std::list<T>> : holds_local_handles<T> { };
+	template<typename T> struct holds_local_handles<std::deque<T>> : holds_local_handles<T> { };
+	template<typename T> struct holds_local_handles<std::set<T>> : holds_local_handles<T> { };
+	template<typename K, typename V> struct holds_local_handles<std::map<K,V>> : holds_local_handles<V> { };
+	template<typename K, typename V> struct holds_local_handles<std::unordered_map<K,V>> : holds_local_handles<V> { };
+
+	namespace impl {
+		template<bool ENABLED>
+		class ChunkHandleScope {
+			public:
+				ChunkHandleScope(v8::Isolate* isolate) : m_scope(isolate) { }
+			private:
+				v8::HandleScope m_scope;
+		};
+
+		template<>
+		class ChunkHandleScope<false> {
+			public:
+				ChunkHandleScope(v8::Isolate* isolate) { }
+		};
+
+		template<typename C> void ReserveElements(C& out, std::size_t n) { }
+		template<typename T> void ReserveElements(std::vector<T>& out, std::size_t n) { out.reserve(n); }
+		template<typename K, typename V> void ReserveElements(std::unordered_map<K,V>& out, std::size_t n) { out.reserve(n); }
+	}
+
+	template<typename It>
+	v8::Local<v8::Array> ConvertRangeToArray(Engine* engine, It it, std::size_t size) {
+		if (size <= Engine::CONVERT_CHUNK_SIZE) {
+			// small ranges - all elements converted first, then packed array is created in one go
+			std::vector<v8::Local<v8::Value>> elements;
+			elements.reserve(size);
+			for(std::size_t i=0;i<size;++i,++it) {
+				elements.push_back(converters::convertTo(engine, *it));
+			}
+			return engine->newArray(elements.data(), elements.size());
+		}
+
+		// big ranges - appending chunk by chunk, every chunk in own HandleScope
+		// appending (instead of preallocating with size) keeps array packed
+		v8::Local<v8::Array> arr = engine->newArray(0);
+		v8::Local<v8::Context> context = engine->context();
+		std::size_t i = 0;
+		while(i < size) {
+			v8::HandleScope chunkScope(engine->isolate());
+			std::size_t end = std::min(size, i + Engine::CONVERT_CHUNK_SIZE);
+			for(;i<end;++i,++it) {
+				// failed converter leaves exception pending, rest is not converted
+				v8::Local<v8::Value> val = converters::convertTo(engine, *it);
+				if (val.IsEmpty() || !arr->Set(context, (uint32_t)i, val).FromMaybe(false)) return arr;
+			}
+		}
+		return arr;
+	}
+
+	template<typename It>
+	v8::Local<v8::Object> ConvertPairsToObject(Engine* engine, It it, It end) {
+		v8::Local<v8::Object> obj = v8::Object::New(engine->isolate());
+		while(it != end) {
+			v8::HandleScope chunkScope(engine->isolate());
+			for(std::size_t n=0;n < Engine::CONVERT_CHUNK_SIZE && it != end;++n,++it) {
+				if (!SetObjectEntry(engine, obj, converters::convertTo(engine, it->first), converters::convertTo(engine, it->second))) return obj;
+			}
+		}
+		return obj;
+	}
+
+	template<typename C>
+	void ConvertArrayElements(Engine* engine, v8::Local<v8::Array> arr, C& out) {
+		typedef typename C::value_type T;
+
+		v8::Local<v8::Context> context = engine->context();
+		uint32_t size = arr->Length();
+		impl::ReserveElements(out, size);
+
+		uint32_t i = 0;
+		while(i < size) {
+			impl::ChunkHandleScope<!holds_local_handles<T>::value> chunkScope(engine->isolate());
+			uint32_t end = (uint32_t)std::min<std::size_t>(size, i + Engine::CONVERT_CHUNK_SIZE);
+			for(;i<end;++i) {
+				v8::Local<v8::Value> val;
+				if (!arr->Get(context, i).ToLocal(&val)) val = engine->newUndefined();
+				out.insert(out.end(), converters::ConverterHelper<T>::from(engine, val));
+			}
+		}
+	}
+
+	template<typename C>
+	void ConvertObjectEntries(Engine* engine, v8::Local<v8::Object> obj, C& out) {
+		typedef typename C::key_type K;
+		typedef typename C::mapped_type V;
+
+		v8::Local<v8::Context> context = engine->context();
+		v8::Local<v8::Array> keys;
+		if (!obj->GetOwnPropertyNames(context).ToLocal(&keys)) return;
+
+		uint32_t size = keys->Length();
+		impl::ReserveElements(out, size);
+
+		uint32_t i = 0;
+		while(i < size) {
+			impl::ChunkHandleScope<!holds_local_handles<K>::value && !holds_local_handles<V>::value> chunkScope(engine->isolate());
+			uint32_t end = (uint32_t)std::min<std::size_t>(size, i + Engine::CONVERT_CHUNK_SIZE);
+			for(;i<end;++i) {
+				v8::Local<v8::Value> key;
+				v8::Local<v8::Value> val;
+				if (!keys->Get(context, i).ToLocal(&key)) continue;
+				if (!obj->Get(context, key).ToLocal(&val)) val = engine->newUndefined();
+				out.insert(out.end(), std::make_pair(converters::ConverterHelper<K>::from(engine, key), converters::ConverterHelper<V>::from(engine, val)));
+			}
+		}
+	}
+
+	// **************************************************************************************************
+	// batch calls
+	// **************************************************************************************************
+
+	struct NoBatchArgs {
+		std::tuple<> operator()(std::size_t index) const { return std::tuple<>(); }
+	};
+
+	inline v8::Local<v8::Object> BatchReceiver(Engine* engine, v8::Local<v8::Object> obj) {
+		return obj;
+	}
+
+	template<typename T>
+	v8::Local<v8::Object> BatchReceiver(Engine* engine, T* obj) {
+		if (obj == nullptr) return v8::Local<v8::Object>();
+		return obj->scriptingGetObject();
+	}
+
+	template<typename T>
+	v8::Local<v8::Object> BatchReceiver(Engine* engine, const stdext::object_ptr<T>& obj) {
+		return BatchReceiver(engine, obj.get());
+	}
+
+	// **************************************************************************************************
+	// constants
+	// **************************************************************************************************
+
+	uint32_t NextEnumTypeId();
+
+	// per-enum index into Engine enum names table
+	template<typename E>
+	struct EnumTypeId {
+		static uint32_t get() {
+			static const uint32_t id = NextEnumTypeId();
+			return id;
+		}
+	};
+
+	void SetTemplateConstant(Engine* engine, v8::Local<v8::ObjectTemplate> tpl, const std::string& name, v8::Local<v8::Value> val);
+
+	namespace impl {
+		struct SetTemplateConstantsImpl {
+			static void apply(Engine* engine, v8::Local<v8::ObjectTemplate>& tpl) {
+
+			}
+			template<typename K, typename V, typename... Args>
+			static void apply(Engine* engine, v8::Local<v8::ObjectTemplate>& tpl, const K& k, const V& v, const Args&... args) {
+				SetTemplateConstant(engine, tpl, k, converters::convertTo(engine, v));
+				SetTemplateConstantsImpl::apply(engine, tpl, args...);
+			}
+		};
+	}
+
+	template<typename... Args>
+	void SetTemplateConstants(Engine* engine, v8::Local<v8::ObjectTemplate>& tpl, const Args&... args) {
+		impl::SetTemplateConstantsImpl::apply(engine, tpl, args...);
+	}
+
 	bool SetObjectPropChain(Engine* engine, v8::Local<v8::Object> obj, const std::string& name, const v8::Local<v8::Value>& val);
 	std::string normalizePrototypeName(const std::string& name, const std::string& ns);
 	void callCtorEvent(Engine* engine, v8::Local<v8::Object>& obj, const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) preg-v8-binder <https://github.com/pregusia/preg-v8-binder>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef INCLUDE_SCRIPTING_METHODS_H_
+#define INCLUDE_SCRIPTING_METHODS_H_
+
+#include "base.h"
+#include <v8.h>
+
+namespace scripting {
+
+	class Engine;
+	class ScriptableObject;
+
+	namespace internal {
+
+		class MethodCacheEntry;
+
+		// method name interned by engine, key string created once
+		class MethodName {
+			public:
+				std::string name;
+				v8::Persistent<v8::String> key;
+				MethodCacheEntry* last;			// entry of last prototype seen, checked before cache probe
+
+				MethodName(const std::string& name) : name(name), last(nullptr) { }
+				~MethodName() { key.Reset(); }
+		};
+
+		// method of (prototype, name) pair - valid while generation matches engine one, which is
+		// bumped on every compile and native registration. Both handles are weak, so cache keeps
+		// neither prototype nor function alive
+		class MethodCacheEntry {
+			public:
+				MethodName* name;
+				v8::Persistent<v8::Object> proto;
+				v8::Persistent<v8::Function> func;
+				uint32_t generation;
+				bool found;
+
+				MethodCacheEntry(MethodName* name) : name(name), generation(0), found(false) { }
+				~MethodCacheEntry() {
+					if (name->last == this) name->last = nullptr;
+					proto.Reset();
+					func.Reset();
+				}
+		};
+
+	}
+
+	template<typename SIG> class MethodHandle;
+
+	// prepared call of script method - name is resolved once, lookups go through engine method cache
+	template<typename R, typename... Args>
+	class MethodHandle<R(Args...)> {
+		public:
+			MethodHandle(Engine* engine, const std::string& name);
+
+			bool exists(v8::Local<v8::Object> obj);
+			R call(v8::Local<v8::Object> obj, const Args&... args);
+			R call(ScriptableObject* obj, const Args&... args);
+
+			R operator()(v8::Local<v8::Object> obj, const Args&... args) { return call(obj, args...); }
+			R operator()(ScriptableObject* obj, const Args&... args) { return call(obj, args...); }
+
+		private:
+			Engine* m_engine;
+			internal::MethodName* m_name;
+	};
+
+}
+
+#include "engine.h"
+
+namespace scripting {
+
+	// ************************************************************************************
+	template<typename R, typename... Args>
+	MethodHandle<R(Args...)>::MethodHandle(Engine* engine, const std::string& name) : m_engine(engine) {
+		ScriptingScope scope(engine);
+		m_name = engine->internMethodName(name);
+	}
+
+	// ************************************************************************************
+	template<typename R, typename... Args>
+	bool MethodHandle<R(Args...)>::exists(v8::Local<v8::Object> obj) {
+		ScriptingScope scope(m_engine);
+		return !m_engine->findMethod(obj, m_name).IsEmpty();
+	}
+
+	// ************************************************************************************
+	template<typename R, typename... Args>
+	R MethodHandle<R(Args...)>::call(v8::Local<v8::Object> obj, const Args&... args) {
+		ScriptingScope scope(m_engine);
+		return m_engine->CallScriptFunction<R>(m_engine->findMethod(obj, m_name), obj, args...);
+	}
+
+	// ************************************************************************************
+	template<typename R, typename... Args>
+	R MethodHandle<R(Args...)>::call(ScriptableObject* obj, const Args&... args) {
+		ScriptingScope scope(m_engine);
+		v8::Local<v8::Object> self = obj->scriptingGetObject();
+		return m_engine->CallScriptFunction<R>(m_engine->findMethod(self, m_name), self, args...);
+	}
+
+}
+
+#endif /* INCLUDE_SCRIPTING_METHODS_H_ */
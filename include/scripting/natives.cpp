@@ -59,26 +59,28 @@ namespace scripting {
 	// ************************************************************************************
 	void NativeFunctions::StringFormat(const v8::FunctionCallbackInfo<v8::Value>& args) {
 		Engine* engine = (Engine*)v8::Local<v8::External>::Cast(args.Data())->Value();
+		ArgsView view(engine, args);
+		ReturnSlot ret = view.returnSlot();
 
 		// string.format(fmt, ...) <- like c format
 
-		if (args.Length() == 0) {
-			args.GetReturnValue().Set(engine->newString(""));
+		if (view.length() == 0) {
+			ret.setEmptyString();
 			return;
 		}
 
-		if (args.Length() == 1) {
-			args.GetReturnValue().Set(args[0]);
+		if (view.length() == 1) {
+			ret.set(view[0]);
 			return;
 		}
 
 		std::stringstream ss;
-		std::string format = converters::ConverterHelper<std::string>::from(engine, args[0]);
+		std::string format = view.get<std::string>(0);
 		std::string::size_type pos = 0;
 		int32_t argNr = 1;
 
 		if (format.empty()) {
-			args.GetReturnValue().Set(engine->newString(""));
+			ret.setEmptyString();
 			return;
 		}
 
@@ -103,19 +105,19 @@ namespace scripting {
 					continue;
 				}
 				if (fmt.back() == 'd') {
-					int32_t v = (argNr < args.Length()) ? converters::ConverterHelper<int32_t>::from(engine, args[argNr]) : 0;
+					int32_t v = view.get<int32_t>(argNr);
 					ss << stdext::format(fmt, v);
 					argNr += 1;
 					continue;
 				}
 				if (fmt.back() == 'f') {
-					float v = (argNr < args.Length()) ? converters::ConverterHelper<float>::from(engine, args[argNr]) : 0;
+					float v = view.get<float>(argNr);
 					ss << stdext::format(fmt, v);
 					argNr += 1;
 					continue;
 				}
 				if (fmt.back() == 's') {
-					std::string v = (argNr < args.Length()) ? converters::ConverterHelper<std::string>::from(engine, args[argNr]) : "";
+					std::string v = view.get<std::string>(argNr);
 					ss << stdext::format(fmt, v);
 					argNr += 1;
 					continue;
@@ -130,7 +132,7 @@ namespace scripting {
 			}
 		}
 
-		args.GetReturnValue().Set(engine->newString(ss.str()));
+		ret.set(engine->newString(ss.str()));
 	}
 
 
@@ -27,7 +27,11 @@ namespace scripting {
 
 	// ************************************************************************************
 	ScriptableObject::ScriptableObject() {
-		m_scriptingMemory = 1024;
+		m_scriptingMemory = -1;
+		m_scriptingCharged = 0;
+		m_scriptingPrototype = -1;
+		m_scriptingLifetime = WrapperLifetime::WEAK;
+		m_scriptingSelf = nullptr;
 	}
 
 	// ************************************************************************************
@@ -51,19 +55,39 @@ namespace scripting {
 		}
 
 		if (m_scriptingObject.IsEmpty()) {
-			v8::Local<v8::Object> obj = g_engineScripting->newObjectFromPrototype(m_scriptingClassName,
+			Engine::Prototype* proto = g_engineScripting->findPrototypeByName(m_scriptingClassName);
+			if (proto == nullptr) throw ScriptingException(stdext::format("Could not find prototype %s", m_scriptingClassName));
+
+			v8::Local<v8::Object> obj = proto->NewInstance();
+			internal::SetObjectProps(g_engineScripting, obj,
 				"__scriptingClassName", m_scriptingClassName,
 				"__nativeClassName", stdext::demangled_name::createFromString(typeid(*this).name()).full()
 			);
 
-			assert(obj->InternalFieldCount() > 0);
-			stdext::object_ptr<ScriptableObject>* ptr = new stdext::object_ptr<ScriptableObject>(dynamic_self_cast<ScriptableObject>());
-			obj->SetInternalField(0, g_engineScripting->newExternal(ptr));
-
+			assert(obj->InternalFieldCount() >= internal::WRAPPER_FIELD_COUNT);
+			stdext::object_ptr<ScriptableObject>* ptr = stdext::pool_new<stdext::object_ptr<ScriptableObject>>(dynamic_self_cast<ScriptableObject>());
 			m_scriptingObject.Reset(g_engineScripting->isolate(), obj);
-			g_engineScripting->isolate()->AdjustAmountOfExternalAllocatedMemory(m_scriptingMemory);
-
-			__refsInc();
+			m_scriptingSelf = ptr;
+			m_scriptingLifetime = scriptingLifetime();
+
+			if (m_scriptingLifetime == WrapperLifetime::TRACED) {
+				// pool blocks are 16 byte aligned, as required for aligned pointer fields
+				obj->SetAlignedPointerInInternalField(internal::WRAPPER_FIELD_SELF, ptr);
+				obj->SetAlignedPointerInInternalField(internal::WRAPPER_FIELD_TRACED, this);
+				obj->SetInternalField(internal::WRAPPER_FIELD_TAG, v8::Integer::New(g_engineScripting->isolate(), internal::WRAPPER_TAG_TRACED));
+				g_engineScripting->heapTracer()->add(this);
+			} else {
+				obj->SetInternalField(internal::WRAPPER_FIELD_SELF, g_engineScripting->newExternal(ptr));
+				obj->SetInternalField(internal::WRAPPER_FIELD_TAG, v8::Integer::New(g_engineScripting->isolate(), internal::WRAPPER_TAG_EXTERNAL));
+			}
+
+			// charged amount is kept, so release subtracts exactly the same
+			m_scriptingCharged = ((m_scriptingMemory >= 0) ? m_scriptingMemory : (int64_t)proto->nativeSize) + scriptingExternalSize();
+			g_engineScripting->externalMemoryAllocated(ExternalMemoryKind::OBJECT, m_scriptingCharged);
+
+			m_scriptingPrototype = proto->index;
+			proto->liveWrappers += 1;
+			proto->peakWrappers = std::max(proto->peakWrappers, proto->liveWrappers);
 
 			/*
 			utils::logDebug(stdext::format("Mapping object #%d of class %s [Native %s] to scripting. refs=%d",
@@ -74,18 +98,114 @@ namespace scripting {
 			));
 			*/
 
-			m_scriptingObject.SetWeak((void*)ptr,&freeCallback, v8::WeakCallbackType::kParameter);
+			// ptr is the only reference when not owned by native code
+			bool weak = (m_scriptingLifetime == WrapperLifetime::WEAK || m_scriptingLifetime == WrapperLifetime::TRACED);
+			if (m_scriptingLifetime == WrapperLifetime::STRONG_WHILE_NATIVE_ALIVE && __refsCount() == 1) weak = true;
+			if (weak) m_scriptingObject.SetWeak((void*)ptr,&freeCallback, v8::WeakCallbackType::kParameter);
 		}
 
 		return m_scriptingObject.Get(g_engineScripting->isolate());
 	}
 
+	// ************************************************************************************
+	stdext::object_ptr<ScriptableObject>* ScriptableObject::scriptingWrapperSlot(v8::Local<v8::Value> val) {
+		if (val.IsEmpty() || !val->IsObject()) return nullptr;
+
+		v8::Local<v8::Object> obj = v8::Local<v8::Object>::Cast(val);
+		if (obj->InternalFieldCount() < internal::WRAPPER_FIELD_COUNT) return nullptr;
+
+		v8::Local<v8::Value> tag = obj->GetInternalField(internal::WRAPPER_FIELD_TAG);
+		if (tag.IsEmpty() || !tag->IsInt32()) return nullptr;
+
+		int32_t kind = v8::Local<v8::Int32>::Cast(tag)->Value();
+		if (kind == internal::WRAPPER_TAG_TRACED) {
+			return static_cast<stdext::object_ptr<ScriptableObject>*>(obj->GetAlignedPointerFromInternalField(internal::WRAPPER_FIELD_SELF));
+		}
+		if (kind != internal::WRAPPER_TAG_EXTERNAL) return nullptr;
+
+		v8::Local<v8::Value> self = obj->GetInternalField(internal::WRAPPER_FIELD_SELF);
+		if (self.IsEmpty() || !self->IsExternal()) return nullptr;
+		return static_cast<stdext::object_ptr<ScriptableObject>*>(v8::Local<v8::External>::Cast(self)->Value());
+	}
+
+	// ************************************************************************************
+	void ScriptableObject::scriptingDispose() {
+		if (m_scriptingObject.IsEmpty()) return;
+
+		ScriptingScope scope(g_engineScripting);
+		v8::Local<v8::Object> obj = m_scriptingObject.Get(g_engineScripting->isolate());
+		if (m_scriptingLifetime == WrapperLifetime::TRACED) {
+			obj->SetAlignedPointerInInternalField(internal::WRAPPER_FIELD_SELF, nullptr);
+			obj->SetAlignedPointerInInternalField(internal::WRAPPER_FIELD_TRACED, nullptr);
+		} else {
+			obj->SetInternalField(internal::WRAPPER_FIELD_SELF, g_engineScripting->newExternal(nullptr));
+		}
+
+		stdext::object_ptr<ScriptableObject>* ptr = m_scriptingSelf;
+		scriptingDetachWrapper();
+		stdext::pool_delete(ptr);
+	}
+
+	// ************************************************************************************
+	void ScriptableObject::scriptingDetachWrapper() {
+		if (m_scriptingLifetime == WrapperLifetime::STRONG_WHILE_NATIVE_ALIVE) g_engineScripting->cancelLifetimeChange(this);
+		m_scriptingObject.Reset();
+		m_scriptingSelf = nullptr;
+		if (m_scriptingLifetime == WrapperLifetime::TRACED) g_engineScripting->heapTracer()->remove(this);
+
+		g_engineScripting->externalMemoryReleased(ExternalMemoryKind::OBJECT, m_scriptingCharged);
+		m_scriptingCharged = 0;
+
+		Engine::Prototype* proto = g_engineScripting->prototypeAt(m_scriptingPrototype);
+		if (proto != nullptr) proto->liveWrappers -= 1;
+		m_scriptingPrototype = -1;
+	}
+
+	// ************************************************************************************
+	void ScriptableObject::__refsInc() {
+		stdext::object::__refsInc();
+
+		// native owner appeared besides wrapper - can run on any thread, engine switches handle
+		// at once only on isolate thread
+		if (m_scriptingLifetime == WrapperLifetime::STRONG_WHILE_NATIVE_ALIVE && __refsCount() == 2 && m_scriptingSelf != nullptr) {
+			g_engineScripting->queueLifetimeChange(this);
+		}
+	}
+
+	// ************************************************************************************
+	void ScriptableObject::__refsDec() {
+		// last native owner goes away, only wrapper remains (so object stays alive after decrement);
+		// lifetime is decided from count, so change is queued after it
+		bool lastOwner = (m_scriptingLifetime == WrapperLifetime::STRONG_WHILE_NATIVE_ALIVE && __refsCount() == 2 && m_scriptingSelf != nullptr);
+
+		stdext::object::__refsDec();
+		if (lastOwner) g_engineScripting->queueLifetimeChange(this);
+	}
+
+	// ************************************************************************************
+	void ScriptableObject::scriptingApplyLifetime() {
+		if (m_scriptingObject.IsEmpty() || m_scriptingLifetime != WrapperLifetime::STRONG_WHILE_NATIVE_ALIVE) return;
+
+		// decided from current count, so flips queued in between cancel out
+		if (__refsCount() > 1) {
+			m_scriptingObject.ClearWeak();
+		} else {
+			m_scriptingObject.SetWeak((void*)m_scriptingSelf, &freeCallback, v8::WeakCallbackType::kParameter);
+		}
+	}
+
+	// ************************************************************************************
+	stdext::object_ptr<WeakReference> WeakReference::scriptingCtor(const stdext::object_ptr<ScriptableObject>& target) {
+		return new WeakReference(target);
+	}
+
 	// ************************************************************************************
 	void ScriptableObject::freeCallback(const v8::WeakCallbackInfo<void>& info) {
 		stdext::object_ptr<ScriptableObject>* ptr = static_cast<stdext::object_ptr<ScriptableObject>*>(info.GetParameter());
-		(*ptr)->m_scriptingObject.Reset();
-		g_engineScripting->isolate()->AdjustAmountOfExternalAllocatedMemory((*ptr)->m_scriptingMemory);
-		delete ptr;
+		(*ptr)->scriptingDetachWrapper();
+
+		// destructors run later, outside GC pause
+		g_engineScripting->finalizationQueue().push(ptr);
 	}
 
 } /* namespace scripting */
@@ -31,6 +31,38 @@
 namespace scripting {
 
 	class Engine;
+	struct BatchCallError;
+	class ReferenceTracer;
+	namespace internal {
+		class HeapTracer;
+
+		// internal fields of ScriptableObject wrappers; views and native singletons keep aligned
+		// pointers in field 0 too, so wrapper is recognized only by tag
+		enum WrapperField {
+			WRAPPER_FIELD_SELF = 0,			// object_ptr<ScriptableObject>*
+			WRAPPER_FIELD_TRACED = 1,		// ScriptableObject* of TRACED object
+			WRAPPER_FIELD_TAG = 2,
+			WRAPPER_FIELD_COUNT = 4
+		};
+		enum WrapperTag {
+			WRAPPER_TAG_EXTERNAL = 0x5357,		// self stored as v8::External
+			WRAPPER_TAG_TRACED = 0x5358			// self and object as aligned pointers - v8 reports only
+												// wrappers with aligned pointers in fields 0 and 1 to tracer
+		};
+	}
+
+	// how long JS wrapper of object lives (wrapper always holds reference to native object)
+	enum class WrapperLifetime {
+		WEAK,						// collected when not reachable from scripts
+		STRONG_WHILE_NATIVE_ALIVE,	// kept while native code holds other references, then weak; switch is
+									// applied at once on thread holding isolate, from other threads at
+									// next outermost ScriptingScope (wrapper collected before that is
+									// recreated on next scriptingGetObject);
+									// reference count itself is not atomic, copies of object_ptr to one
+									// object must not race each other (ThreadingMode::SHARED)
+		DISPOSABLE_ONLY,			// kept until scriptingDispose()
+		TRACED						// weak, references reported by scriptingTraceReferences keep each other alive
+	};
 
 	class ScriptableObject : public virtual stdext::object {
 		public:
@@ -39,43 +71,72 @@ namespace scripting {
 			bool scriptingEnabled() const { return true; }
 
 			template<typename R, typename... Args>
-			R scriptingCallMethod(const std::string& name, Args... args);
+			R scriptingCallMethod(const std::string& name, const Args&... args);
 
 			template<typename... Args>
-			bool scriptingCallEvent(const std::string& name, Args... args);
+			bool scriptingCallEvent(const std::string& name, const Args&... args);
 
 			template<typename RET, typename... Args>
-			std::vector<RET> scriptingCallEventReturn(const std::string& name, Args... args);
+			std::vector<RET> scriptingCallEventReturn(const std::string& name, const Args&... args);
+
+			// calls method on each object in single scope, argsProvider(index) returns std::tuple<Args...>
+			template<typename... Args, typename C, typename P>
+			static std::vector<BatchCallError> scriptingCallMethodBatch(const std::string& name, const C& objects, const P& argsProvider);
+
+			template<typename C>
+			static std::vector<BatchCallError> scriptingCallMethodBatch(const std::string& name, const C& objects);
 
 			template<typename R>
 			R scriptingGetField(const std::string& name1, const std::string& name2 = "", const std::string& name3 = "");
 
 			v8::Local<v8::Object> scriptingGetObject();
 			const std::string& scriptingClassName() const { return m_scriptingClassName; }
-			void scriptingSetClassNameInternal(const std::string& s, int32_t usedMemory = 1024);
+
+			// usedMemory < 0 - size of registered native class (sizeof) is used
+			void scriptingSetClassNameInternal(const std::string& s, int32_t usedMemory = -1);
+
+			// native memory owned by object besides its own size (buffers etc.), counted when object is mapped
+			virtual std::size_t scriptingExternalSize() const { return 0; }
+
+			// wrapper lifetime policy of class, read when object is mapped
+			virtual WrapperLifetime scriptingLifetime() const { return WrapperLifetime::WEAK; }
+
+			// TRACED objects report here their TracedHandle members and referenced objects,
+			// called by v8 garbage collector, so must not allocate v8 objects
+			virtual void scriptingTraceReferences(ReferenceTracer& tracer) { }
+
+			// true when destructor touches neither v8 nor engine thread state - collected objects are
+			// then destroyed by background thread instead of engine thread. Such class must not own
+			// object_ptr (or weak_ptr) to other objects: reference counts are not atomic and are
+			// changed by engine thread at the same time; plain members and buffers only
+			virtual bool scriptingDestroyAnyThread() const { return false; }
+
+			// detaches JS wrapper - further use of it from scripts throws, reference held by wrapper
+			// is dropped immediately (object can be deleted here); next scriptingGetObject creates new wrapper
+			void scriptingDispose();
+
+			virtual void __refsInc();
+			virtual void __refsDec();
 
 			virtual void eventRegister(const std::string& name) { }
 			virtual void eventUnregister(const std::string& name) { }
 
+			// reference held by wrapper, nullptr when val is not wrapper of ScriptableObject (or was disposed)
+			static stdext::object_ptr<ScriptableObject>* scriptingWrapperSlot(v8::Local<v8::Value> val);
+
 			template<typename C>
 			static C* unwrap(v8::Local<v8::Value> val) {
 				if (val.IsEmpty()) {
-					utils::logWarning(stdext::format("Unwrapping object of class %s failed - val.empty", stdext::demangled_name::get<C>().full()));
+					utils::logWarningLimited("unwrap: val.empty", &typeid(C), [] { return stdext::format("Unwrapping object of class %s failed - val.empty", stdext::demangled_name::get<C>().full()); });
 					return nullptr;
 				}
 				if (!val->IsObject()) {
-					utils::logWarning(stdext::format("Unwrapping object of class %s failed - not object", stdext::demangled_name::get<C>().full()));
-					return nullptr;
-				}
-				v8::Local<v8::Object> obj = v8::Local<v8::Object>::Cast(val);
-				if (obj->InternalFieldCount() == 0) {
-					utils::logWarning(stdext::format("Unwrapping object of class %s failed - ifc == 0", stdext::demangled_name::get<C>().full()));
+					utils::logWarningLimited("unwrap: not object", &typeid(C), [] { return stdext::format("Unwrapping object of class %s failed - not object", stdext::demangled_name::get<C>().full()); });
 					return nullptr;
 				}
-
-				stdext::object_ptr<ScriptableObject>* ptr = (stdext::object_ptr<ScriptableObject>*)v8::Local<v8::External>::Cast(obj->GetInternalField(0))->Value();
+				stdext::object_ptr<ScriptableObject>* ptr = scriptingWrapperSlot(val);
 				if (ptr == nullptr) {
-					utils::logWarning(stdext::format("Unwrapping object of class %s failed - ptr NULL", stdext::demangled_name::get<C>().full()));
+					utils::logWarningLimited("unwrap: ptr NULL", &typeid(C), [] { return stdext::format("Unwrapping object of class %s failed - ptr NULL", stdext::demangled_name::get<C>().full()); });
 					return nullptr;
 				}
 
@@ -86,11 +147,37 @@ namespace scripting {
 		protected:
 			v8::Persistent<v8::Object> m_scriptingObject;
 			int32_t m_scriptingMemory;
+			int64_t m_scriptingCharged;
+			int32_t m_scriptingPrototype;
+			WrapperLifetime m_scriptingLifetime;
+			stdext::object_ptr<ScriptableObject>* m_scriptingSelf;
+
+			void scriptingDetachWrapper();
+			void scriptingApplyLifetime();
+
+			friend class internal::HeapTracer;
+			friend class Engine;
 			std::string m_scriptingClassName;
 
 			static void freeCallback(const v8::WeakCallbackInfo<void>& info);
 	};
 
+	// script side of stdext::weak_object_ptr - new WeakReference(obj), get() returns null when object is gone
+	class WeakReference : public ScriptableObject {
+		public:
+			WeakReference() { }
+			explicit WeakReference(const stdext::weak_object_ptr<ScriptableObject>& target) : m_target(target) { }
+
+			static stdext::object_ptr<WeakReference> scriptingCtor(const stdext::object_ptr<ScriptableObject>& target);
+
+			stdext::object_ptr<ScriptableObject> get() const { return m_target.lock(); }
+			bool expired() const { return m_target.expired(); }
+			const stdext::weak_object_ptr<ScriptableObject>& target() const { return m_target; }
+
+		private:
+			stdext::weak_object_ptr<ScriptableObject> m_target;
+	};
+
 } /* namespace scripting */
 
 #include "engine.h"
@@ -99,7 +186,7 @@ namespace scripting {
 
 	// ************************************************************************************
 	template<typename R, typename... Args>
-	R ScriptableObject::scriptingCallMethod(const std::string& name, Args... args) {
+	R ScriptableObject::scriptingCallMethod(const std::string& name, const Args&... args) {
 		ScriptingScope scope(g_engineScripting);
 
 		v8::Local<v8::Object> obj = scriptingGetObject();
@@ -108,6 +195,18 @@ namespace scripting {
 		// TODO: check exception somehow
 	}
 
+	// ************************************************************************************
+	template<typename... Args, typename C, typename P>
+	std::vector<BatchCallError> ScriptableObject::scriptingCallMethodBatch(const std::string& name, const C& objects, const P& argsProvider) {
+		return g_engineScripting->invokeBatch<Args...>(name, objects, argsProvider);
+	}
+
+	// ************************************************************************************
+	template<typename C>
+	std::vector<BatchCallError> ScriptableObject::scriptingCallMethodBatch(const std::string& name, const C& objects) {
+		return g_engineScripting->invokeBatch(name, objects);
+	}
+
 	// ************************************************************************************
 	template<typename R>
 	R ScriptableObject::scriptingGetField(const std::string& name1, const std::string& name2, const std::string& name3) {
@@ -139,13 +238,13 @@ namespace scripting {
 
 	// ************************************************************************************
 	template<typename... Args>
-	bool ScriptableObject::scriptingCallEvent(const std::string& name, Args... args) {
+	bool ScriptableObject::scriptingCallEvent(const std::string& name, const Args&... args) {
 		//utils::logDebug(stdext::format("Calling event %s on [%s %s]", name, m_scriptingClassName, stdext::demangle_name(typeid(*this).name())));
 		ScriptingScope scope(g_engineScripting);
 
 		v8::Local<v8::Function> dollarFunc = g_engineScripting->getGlobalFunction("$");
 		if (!dollarFunc.IsEmpty()) {
-			bool res = g_engineScripting->CallObjectProperty<bool>(dollarFunc, "eventCallStatic", scriptingGetObject(), name, args...);
+			bool res = g_engineScripting->CallObjectProperty<bool>(dollarFunc, g_engineScripting->eventDispatcherName(false), scriptingGetObject(), name, args...);
 			scope.checkThrowException();
 			return res;
 		}
@@ -155,13 +254,13 @@ namespace scripting {
 
 	// ************************************************************************************
 	template<typename RET, typename... Args>
-	std::vector<RET> ScriptableObject::scriptingCallEventReturn(const std::string& name, Args... args) {
+	std::vector<RET> ScriptableObject::scriptingCallEventReturn(const std::string& name, const Args&... args) {
 		//utils::logDebug(stdext::format("Calling event %s on [%s %s]", name, m_scriptingClassName, stdext::demangle_name(typeid(*this).name())));
 		ScriptingScope scope(g_engineScripting);
 
 		v8::Local<v8::Function> dollarFunc = g_engineScripting->getGlobalFunction("$");
 		if (!dollarFunc.IsEmpty()) {
-			std::vector<RET> res = g_engineScripting->CallObjectProperty<std::vector<RET>>(dollarFunc, "eventCallStaticReturn", scriptingGetObject(), name, args...);
+			std::vector<RET> res = g_engineScripting->CallObjectProperty<std::vector<RET>>(dollarFunc, g_engineScripting->eventDispatcherName(true), scriptingGetObject(), name, args...);
 			scope.checkThrowException();
 			return res;
 		}
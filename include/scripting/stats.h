@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) preg-v8-binder <https://github.com/pregusia/preg-v8-binder>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef INCLUDE_SCRIPTING_STATS_H_
+#define INCLUDE_SCRIPTING_STATS_H_
+
+#include "base.h"
+#include "structs.h"
+
+namespace scripting {
+
+	struct HeapSpaceStats {
+		std::string name;
+		std::size_t size;
+		std::size_t used;
+		std::size_t available;
+		std::size_t physical;
+
+		HeapSpaceStats() : size(0), used(0), available(0), physical(0) { }
+
+		static void scriptingStruct(StructDescriptor<HeapSpaceStats>& d) {
+			d.field("name", &HeapSpaceStats::name)
+				.field("size", &HeapSpaceStats::size)
+				.field("used", &HeapSpaceStats::used)
+				.field("available", &HeapSpaceStats::available)
+				.field("physical", &HeapSpaceStats::physical);
+		}
+	};
+
+	struct PrototypeStats {
+		std::string name;
+		std::size_t liveWrappers;
+		std::size_t peakWrappers;
+
+		PrototypeStats() : liveWrappers(0), peakWrappers(0) { }
+
+		static void scriptingStruct(StructDescriptor<PrototypeStats>& d) {
+			d.field("name", &PrototypeStats::name)
+				.field("liveWrappers", &PrototypeStats::liveWrappers)
+				.field("peakWrappers", &PrototypeStats::peakWrappers);
+		}
+	};
+
+	// snapshot returned by Engine::stats(), peak values are since engine start or last resetPeaks()
+	struct EngineStats {
+		// v8 heap
+		std::size_t totalHeapSize;
+		std::size_t usedHeapSize;
+		std::size_t heapSizeLimit;
+		std::size_t totalPhysicalSize;
+		std::size_t mallocedMemory;
+		std::vector<HeapSpaceStats> heapSpaces;
+		std::size_t codeAndMetadataSize;
+		std::size_t bytecodeAndMetadataSize;
+
+		// bindings
+		std::vector<PrototypeStats> prototypes;
+		std::size_t liveWrappers;
+		std::size_t functionHolders;
+		std::size_t persistentHandles;
+		int64_t externalMemory;
+		int64_t externalMemoryReported;
+		std::size_t pendingFinalizers;
+
+		// stdext pool allocator (pooled_object classes, wrapper references)
+		uint64_t poolAllocations;
+		uint64_t poolDeallocations;
+		uint64_t poolLargeAllocations;
+		std::size_t poolReservedBytes;
+
+		// binding metadata arena (prototypes, function holders, interned names)
+		std::size_t bindingArenaReserved;
+		std::size_t bindingArenaUsed;
+		std::size_t internedNames;
+
+		// peaks
+		std::size_t peakUsedHeapSize;
+		std::size_t peakMallocedMemory;
+		std::size_t peakLiveWrappers;
+		std::size_t peakFunctionHolders;
+		int64_t peakExternalMemory;
+
+		EngineStats() : totalHeapSize(0), usedHeapSize(0), heapSizeLimit(0), totalPhysicalSize(0), mallocedMemory(0), codeAndMetadataSize(0), bytecodeAndMetadataSize(0),
+			liveWrappers(0), functionHolders(0), persistentHandles(0), externalMemory(0), externalMemoryReported(0), pendingFinalizers(0), poolAllocations(0), poolDeallocations(0), poolLargeAllocations(0), poolReservedBytes(0), bindingArenaReserved(0), bindingArenaUsed(0), internedNames(0),
+			peakUsedHeapSize(0), peakMallocedMemory(0), peakLiveWrappers(0), peakFunctionHolders(0), peakExternalMemory(0) { }
+
+		static void scriptingStruct(StructDescriptor<EngineStats>& d) {
+			d.field("totalHeapSize", &EngineStats::totalHeapSize)
+				.field("usedHeapSize", &EngineStats::usedHeapSize)
+				.field("heapSizeLimit", &EngineStats::heapSizeLimit)
+				.field("totalPhysicalSize", &EngineStats::totalPhysicalSize)
+				.field("mallocedMemory", &EngineStats::mallocedMemory)
+				.field("heapSpaces", &EngineStats::heapSpaces)
+				.field("codeAndMetadataSize", &EngineStats::codeAndMetadataSize)
+				.field("bytecodeAndMetadataSize", &EngineStats::bytecodeAndMetadataSize)
+				.field("prototypes", &EngineStats::prototypes)
+				.field("liveWrappers", &EngineStats::liveWrappers)
+				.field("functionHolders", &EngineStats::functionHolders)
+				.field("persistentHandles", &EngineStats::persistentHandles)
+				.field("externalMemory", &EngineStats::externalMemory)
+				.field("externalMemoryReported", &EngineStats::externalMemoryReported)
+				.field("pendingFinalizers", &EngineStats::pendingFinalizers)
+				.field("poolAllocations", &EngineStats::poolAllocations)
+				.field("poolDeallocations", &EngineStats::poolDeallocations)
+				.field("poolLargeAllocations", &EngineStats::poolLargeAllocations)
+				.field("poolReservedBytes", &EngineStats::poolReservedBytes)
+				.field("bindingArenaReserved", &EngineStats::bindingArenaReserved)
+				.field("bindingArenaUsed", &EngineStats::bindingArenaUsed)
+				.field("internedNames", &EngineStats::internedNames)
+				.field("peakUsedHeapSize", &EngineStats::peakUsedHeapSize)
+				.field("peakMallocedMemory", &EngineStats::peakMallocedMemory)
+				.field("peakLiveWrappers", &EngineStats::peakLiveWrappers)
+				.field("peakFunctionHolders", &EngineStats::peakFunctionHolders)
+				.field("peakExternalMemory", &EngineStats::peakExternalMemory);
+		}
+	};
+
+} /* namespace scripting */
+
+#endif /* INCLUDE_SCRIPTING_STATS_H_ */
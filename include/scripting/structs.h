@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) preg-v8-binder <https://github.com/pregusia/preg-v8-binder>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef INCLUDE_SCRIPTING_STRUCTS_H_
+#define INCLUDE_SCRIPTING_STRUCTS_H_
+
+#include "base.h"
+#include <v8.h>
+#include <memory>
+#include "converters.h"
+
+namespace scripting {
+
+	class Engine;
+
+	namespace internal {
+
+		uint32_t NextStructTypeId();
+
+		// per-type index into Engine struct templates table
+		template<typename T>
+		struct StructTypeId {
+			static uint32_t get() {
+				static const uint32_t id = NextStructTypeId();
+				return id;
+			}
+		};
+
+		template<typename T>
+		class StructField {
+			public:
+				std::string name;
+				v8::Persistent<v8::String> key;
+
+				StructField(const std::string& name) : name(name) { }
+				virtual ~StructField() { key.Reset(); }
+
+				virtual v8::Local<v8::Value> get(Engine* engine, const T& obj) const = 0;
+				virtual void set(Engine* engine, v8::Local<v8::Value> val, T& obj) const = 0;
+		};
+
+		template<typename T, typename M>
+		class StructMemberField : public StructField<T> {
+			public:
+				M T::* member;
+
+				StructMemberField(const std::string& name, M T::* member) : StructField<T>(name), member(member) { }
+
+				virtual v8::Local<v8::Value> get(Engine* engine, const T& obj) const {
+					return converters::convertTo(engine, obj.*member);
+				}
+				virtual void set(Engine* engine, v8::Local<v8::Value> val, T& obj) const {
+					converters::convertFrom(engine, val, obj.*member);
+				}
+		};
+
+	}
+
+	// list of struct fields exposed to scripting, filled by T::scriptingStruct
+	template<typename T>
+	class StructDescriptor {
+		public:
+			typedef std::vector<std::unique_ptr<internal::StructField<T>>> FieldsVector;
+
+			template<typename M>
+			StructDescriptor& field(const std::string& name, M T::* member) {
+				m_fields.emplace_back(new internal::StructMemberField<T,M>(name, member));
+				return *this;
+			}
+
+			const FieldsVector& fields() const { return m_fields; }
+
+		private:
+			FieldsVector m_fields;
+	};
+
+	namespace internal {
+
+		class StructTemplateBase {
+			public:
+				v8::Persistent<v8::ObjectTemplate> tpl;
+
+				virtual ~StructTemplateBase() { tpl.Reset(); }
+				v8::Local<v8::ObjectTemplate> GetTemplate(v8::Isolate* isolate) { return tpl.Get(isolate); }
+		};
+
+		// per-engine cached template - every instance has all fields in the same order, so shares hidden class
+		template<typename T>
+		class StructTemplate : public StructTemplateBase {
+			public:
+				StructDescriptor<T> descriptor;
+		};
+
+	}
+
+}
+
+#endif /* INCLUDE_SCRIPTING_STRUCTS_H_ */
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) preg-v8-binder <https://github.com/pregusia/preg-v8-binder>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "engine.h"
+#include <v8-platform.h>
+#include <algorithm>
+#include <limits>
+
+namespace scripting { namespace internal {
+
+	// ************************************************************************************
+	HeapTracer::HeapTracer(Engine* engine) : ReferenceTracer(engine->isolate()), m_engine(engine), m_installed(false) {
+
+	}
+
+	// ************************************************************************************
+	void HeapTracer::add(ScriptableObject* obj) {
+		// installed with first traced object, so engines without them pay nothing
+		if (!m_installed) {
+			m_engine->isolate()->SetEmbedderHeapTracer(this);
+			m_installed = true;
+		}
+		m_objects.insert(obj);
+	}
+
+	// ************************************************************************************
+	void HeapTracer::remove(ScriptableObject* obj) {
+		m_objects.erase(obj);
+		m_visited.erase(obj);
+		m_worklist.erase(std::remove(m_worklist.begin(), m_worklist.end(), obj), m_worklist.end());
+	}
+
+	// ************************************************************************************
+	void HeapTracer::RegisterV8References(const std::vector<std::pair<void*, void*>>& embedderFields) {
+		for(auto& fields: embedderFields) {
+			ScriptableObject* obj = static_cast<ScriptableObject*>(fields.second);
+			if (m_objects.count(obj) > 0 && m_visited.count(obj) == 0) m_worklist.push_back(obj);
+		}
+	}
+
+	// ************************************************************************************
+	void HeapTracer::traceObject(ScriptableObject* obj) {
+		if (obj == nullptr) return;
+
+		// wrapper of referenced object (and JS state kept on it) is reachable through owner
+		if (!obj->m_scriptingObject.IsEmpty()) obj->m_scriptingObject.RegisterExternalReference(m_isolate);
+		if (m_objects.count(obj) > 0 && m_visited.count(obj) == 0) m_worklist.push_back(obj);
+	}
+
+	// ************************************************************************************
+	void HeapTracer::prologue() {
+		clear();
+		for(auto& obj: m_objects) {
+			if (obj->__refsCount() > 1) m_worklist.push_back(obj);
+		}
+	}
+
+	// ************************************************************************************
+	bool HeapTracer::advance(double deadlineInMs) {
+		v8::Platform* platform = m_engine->platform();
+
+		while(!m_worklist.empty()) {
+			ScriptableObject* obj = m_worklist.back();
+			m_worklist.pop_back();
+			if (!m_visited.insert(obj).second) continue;
+
+			obj->scriptingTraceReferences(*this);
+			if (platform->MonotonicallyIncreasingTime() * 1000.0 >= deadlineInMs) break;
+		}
+		return !m_worklist.empty();
+	}
+
+	// ************************************************************************************
+	void HeapTracer::clear() {
+		m_visited.clear();
+		m_worklist.clear();
+	}
+
+	// ************************************************************************************
+	void HeapTracer::TracePrologue() {
+		prologue();
+	}
+
+	// ************************************************************************************
+	bool HeapTracer::AdvanceTracing(double deadlineInMs, v8::EmbedderHeapTracer::AdvanceTracingActions actions) {
+		if (actions.force_completion == v8::EmbedderHeapTracer::FORCE_COMPLETION) {
+			return advance(std::numeric_limits<double>::infinity());
+		}
+		return advance(deadlineInMs);
+	}
+
+	// ************************************************************************************
+	void HeapTracer::TraceEpilogue() {
+		clear();
+	}
+
+	// ************************************************************************************
+	void HeapTracer::EnterFinalPause() {
+
+	}
+
+	// ************************************************************************************
+	void HeapTracer::AbortTracing() {
+		clear();
+	}
+
+} }
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) preg-v8-binder <https://github.com/pregusia/preg-v8-binder>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef INCLUDING_FROM_ENGINE
+#	error "This file should only be included internally"
+#endif
+
+#ifndef INCLUDE_SCRIPTING_TRACING_H_
+#define INCLUDE_SCRIPTING_TRACING_H_
+
+#include <v8.h>
+#include <unordered_set>
+#include <vector>
+
+namespace scripting {
+
+	class Engine;
+	class ScriptableObject;
+
+	// Reference from native object to script value, which does not keep value alive by itself.
+	// Value lives as long as v8 reaches it by tracing owner (scriptingTraceReferences of TRACED object).
+	template<typename T>
+	class TracedHandle {
+		public:
+			TracedHandle() { }
+			TracedHandle(v8::Isolate* isolate, v8::Local<T> value) { reset(isolate, value); }
+			~TracedHandle() { m_handle.Reset(); }
+
+			void reset() { m_handle.Reset(); }
+			void reset(v8::Isolate* isolate, v8::Local<T> value) {
+				m_handle.Reset(isolate, value);
+				if (!m_handle.IsEmpty()) m_handle.SetWeak();
+			}
+
+			// empty when value was collected
+			bool empty() const { return m_handle.IsEmpty(); }
+			v8::Local<T> get(v8::Isolate* isolate) const { return m_handle.Get(isolate); }
+			const v8::Persistent<T>& handle() const { return m_handle; }
+
+		private:
+			TracedHandle(const TracedHandle& from);
+			TracedHandle& operator=(const TracedHandle& from);
+
+			v8::Persistent<T> m_handle;
+	};
+
+	// passed to ScriptableObject::scriptingTraceReferences, object reports there its outgoing references
+	class ReferenceTracer {
+		public:
+			template<typename T>
+			void trace(const TracedHandle<T>& handle) { handle.handle().RegisterExternalReference(m_isolate); }
+
+			template<typename T>
+			void trace(const stdext::object_ptr<T>& obj) { traceObject(dynamic_cast<ScriptableObject*>(obj.get())); }
+
+			void trace(ScriptableObject* obj) { traceObject(obj); }
+
+		protected:
+			ReferenceTracer(v8::Isolate* isolate) : m_isolate(isolate) { }
+			virtual ~ReferenceTracer() { }
+
+			virtual void traceObject(ScriptableObject* obj) = 0;
+
+			v8::Isolate* m_isolate;
+	};
+
+	namespace internal {
+
+		// v8 reports reached wrappers of TRACED objects (internal field 1), objects trace their references.
+		// Objects held by native code besides own wrapper are roots. Written against EmbedderHeapTracer
+		// and RegisterExternalReference of V8 5.8 - 6.x (both replaced by TracedReference API later).
+		class HeapTracer : public v8::EmbedderHeapTracer, public ReferenceTracer {
+			public:
+				HeapTracer(Engine* engine);
+
+				void add(ScriptableObject* obj);
+				void remove(ScriptableObject* obj);
+
+				virtual void RegisterV8References(const std::vector<std::pair<void*, void*>>& embedderFields);
+				virtual void TracePrologue();
+				virtual bool AdvanceTracing(double deadlineInMs, v8::EmbedderHeapTracer::AdvanceTracingActions actions);
+				virtual void TraceEpilogue();
+				virtual void EnterFinalPause();
+				virtual void AbortTracing();
+				virtual std::size_t NumberOfWrappersToTrace() { return m_worklist.size(); }
+
+			protected:
+				virtual void traceObject(ScriptableObject* obj);
+
+			private:
+				Engine* m_engine;
+				bool m_installed;
+				std::unordered_set<ScriptableObject*> m_objects;
+				std::unordered_set<ScriptableObject*> m_visited;
+				std::vector<ScriptableObject*> m_worklist;
+
+				void prologue();
+				bool advance(double deadlineInMs);
+				void clear();
+		};
+
+	}
+
+} /* namespace scripting */
+
+#endif /* INCLUDE_SCRIPTING_TRACING_H_ */
@@ -24,6 +24,8 @@
 #include "utils.h"
 
 #include <cstdio>
+#include <chrono>
+#include <mutex>
 
 namespace scripting { namespace utils {
 
@@ -50,6 +52,39 @@ namespace scripting { namespace utils {
 		printf("[logWarning] %s\n", msg.c_str());
 	}
 
+	// ************************************************************************************
+	bool warningAllowed(const char* site, const void* subject, uint32_t& suppressed) {
+		struct Entry {
+			std::chrono::steady_clock::time_point last;
+			uint32_t suppressed;
+		};
+		static std::mutex mutex;
+		static std::map<std::pair<const char*, const void*>, Entry> entries;
+
+		auto now = std::chrono::steady_clock::now();
+		std::lock_guard<std::mutex> lock(mutex);
+
+		auto it = entries.find(std::make_pair(site, subject));
+		if (it == entries.end()) {
+			Entry entry;
+			entry.last = now;
+			entry.suppressed = 0;
+			entries.insert(std::make_pair(std::make_pair(site, subject), entry));
+			suppressed = 0;
+			return true;
+		}
+
+		if (now - it->second.last < std::chrono::milliseconds(WARNING_INTERVAL_MS)) {
+			it->second.suppressed += 1;
+			return false;
+		}
+
+		suppressed = it->second.suppressed;
+		it->second.last = now;
+		it->second.suppressed = 0;
+		return true;
+	}
+
 	// ************************************************************************************
 	void logScript(const std::string& msg) {
 		printf("[logScript] %s\n", msg.c_str());
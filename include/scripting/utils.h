@@ -36,6 +36,22 @@ namespace scripting { namespace utils {
 	std::string readFileContents(const std::string& path);
 	StringVector split(const std::string& str, char separator);
 
+	// deduplicated and rate limited warnings - same (site, subject) pair is logged at most
+	// once per WARNING_INTERVAL_MS, message is built only when it is really logged
+	static const uint32_t WARNING_INTERVAL_MS = 1000;
+	bool warningAllowed(const char* site, const void* subject, uint32_t& suppressed);
+
+	template<typename F>
+	void logWarningLimited(const char* site, const void* subject, const F& message) {
+		uint32_t suppressed = 0;
+		if (!warningAllowed(site, subject, suppressed)) return;
+
+		if (suppressed > 0) {
+			logWarning(stdext::format("%s (suppressed %d times)", message(), suppressed));
+		} else {
+			logWarning(message());
+		}
+	}
 
 } }
 
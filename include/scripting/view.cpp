@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) preg-v8-binder <https://github.com/pregusia/preg-v8-binder>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "view.h"
+#include "engine.h"
+
+namespace scripting { namespace internal {
+
+	// ************************************************************************************
+	v8::Local<v8::Object> ViewObject::create(Engine* engine, ViewSource* source) {
+		v8::Local<v8::ObjectTemplate> tpl = support(engine)->tpl.Get(engine->isolate());
+
+		v8::Local<v8::Object> obj;
+		if (!tpl->NewInstance(engine->context()).ToLocal(&obj)) {
+			delete source;
+			return v8::Local<v8::Object>();
+		}
+
+		obj->SetAlignedPointerInInternalField(0, source);
+		source->handle.Reset(engine->isolate(), obj);
+		source->handle.SetWeak(source, &ViewObject::freeCallback, v8::WeakCallbackType::kParameter);
+		return obj;
+	}
+
+	// ************************************************************************************
+	ViewSupport* ViewObject::support(Engine* engine) {
+		if (engine->m_viewSupport == nullptr) {
+			v8::Isolate* isolate = engine->isolate();
+			ViewSupport* vs = new ViewSupport();
+
+			v8::Local<v8::ObjectTemplate> tpl = v8::ObjectTemplate::New(isolate);
+			tpl->SetInternalFieldCount(1);
+			tpl->SetHandler(v8::IndexedPropertyHandlerConfiguration(IndexedGetter, IndexedSetter, IndexedQuery, IndexedDeleter, IndexedEnumerator));
+			tpl->SetHandler(v8::NamedPropertyHandlerConfiguration(NamedGetter, NamedSetter, NamedQuery, NamedDeleter, NamedEnumerator));
+			vs->tpl.Reset(isolate, tpl);
+			vs->lengthKey.Reset(isolate, engine->newInternalizedString("length"));
+
+			// Array.prototype[Symbol.iterator] works on any array-like (length + indexes)
+			v8::Local<v8::Object> arrayProto = v8::Array::New(isolate, 0)->GetPrototype()->ToObject(isolate);
+			v8::Local<v8::Value> iterator;
+			if (arrayProto->Get(engine->context(), v8::Symbol::GetIterator(isolate)).ToLocal(&iterator)) {
+				vs->arrayIterator.Reset(isolate, iterator);
+			}
+
+			engine->m_viewSupport = vs;
+		}
+		return engine->m_viewSupport;
+	}
+
+	// ************************************************************************************
+	ViewSource* ViewObject::unwrap(v8::Local<v8::Object> holder) {
+		if (holder->InternalFieldCount() == 0) return nullptr;
+		return static_cast<ViewSource*>(holder->GetAlignedPointerFromInternalField(0));
+	}
+
+	// ************************************************************************************
+	bool ViewObject::inPrototype(Engine* engine, v8::Local<v8::Object> holder, v8::Local<v8::Name> name) {
+		v8::Local<v8::Value> proto = holder->GetPrototype();
+		if (!proto->IsObject()) return false;
+		return proto.As<v8::Object>()->Has(engine->isolate()->GetCurrentContext(), name).FromMaybe(false);
+	}
+
+	// ************************************************************************************
+	void ViewObject::freeCallback(const v8::WeakCallbackInfo<ViewSource>& info) {
+		delete info.GetParameter();
+	}
+
+	// ************************************************************************************
+	void ViewObject::IndexedGetter(uint32_t index, const v8::PropertyCallbackInfo<v8::Value>& info) {
+		Engine* engine = (Engine*)info.GetIsolate()->GetData(0);
+		ViewSource* source = unwrap(info.Holder());
+		if (source == nullptr) return;
+
+		v8::Local<v8::Value> val;
+		if (source->keyed()) {
+			val = source->get(engine, v8::Integer::NewFromUnsigned(engine->isolate(), index));
+		} else {
+			val = source->getIndex(engine, index);
+		}
+		if (!val.IsEmpty()) info.GetReturnValue().Set(val);
+	}
+
+	// ************************************************************************************
+	void ViewObject::IndexedSetter(uint32_t index, v8::Local<v8::Value> value, const v8::PropertyCallbackInfo<v8::Value>& info) {
+		// read only - intercepting without storing
+		info.GetReturnValue().Set(value);
+	}
+
+	// ************************************************************************************
+	void ViewObject::IndexedQuery(uint32_t index, const v8::PropertyCallbackInfo<v8::Integer>& info) {
+		Engine* engine = (Engine*)info.GetIsolate()->GetData(0);
+		ViewSource* source = unwrap(info.Holder());
+		if (source == nullptr) return;
+
+		bool exists = source->keyed() ? source->has(engine, v8::Integer::NewFromUnsigned(engine->isolate(), index)) : (index < source->length());
+		if (exists) info.GetReturnValue().Set(v8::ReadOnly | v8::DontDelete);
+	}
+
+	// ************************************************************************************
+	void ViewObject::IndexedDeleter(uint32_t index, const v8::PropertyCallbackInfo<v8::Boolean>& info) {
+		info.GetReturnValue().Set(false);
+	}
+
+	// ************************************************************************************
+	void ViewObject::IndexedEnumerator(const v8::PropertyCallbackInfo<v8::Array>& info) {
+		Engine* engine = (Engine*)info.GetIsolate()->GetData(0);
+		ViewSource* source = unwrap(info.Holder());
+		if (source == nullptr || source->keyed()) return;
+
+		info.GetReturnValue().Set(source->keys(engine));
+	}
+
+	// ************************************************************************************
+	void ViewObject::NamedGetter(v8::Local<v8::Name> name, const v8::PropertyCallbackInfo<v8::Value>& info) {
+		Engine* engine = (Engine*)info.GetIsolate()->GetData(0);
+		ViewSource* source = unwrap(info.Holder());
+		if (source == nullptr) return;
+
+		ViewSupport* vs = support(engine);
+		if (name->IsSymbol()) {
+			if (!source->keyed() && name->StrictEquals(v8::Symbol::GetIterator(engine->isolate()))) {
+				info.GetReturnValue().Set(vs->arrayIterator.Get(engine->isolate()));
+			}
+			return;
+		}
+
+		if (source->keyed() && !inPrototype(engine, info.Holder(), name)) {
+			v8::Local<v8::Value> val = source->get(engine, name);
+			if (!val.IsEmpty()) {
+				info.GetReturnValue().Set(val);
+				return;
+			}
+		}
+
+		if (name->StrictEquals(vs->lengthKey.Get(engine->isolate()))) {
+			info.GetReturnValue().Set(source->length());
+		}
+	}
+
+	// ************************************************************************************
+	void ViewObject::NamedSetter(v8::Local<v8::Name> name, v8::Local<v8::Value> value, const v8::PropertyCallbackInfo<v8::Value>& info) {
+		// read only - intercepting without storing
+		info.GetReturnValue().Set(value);
+	}
+
+	// ************************************************************************************
+	void ViewObject::NamedQuery(v8::Local<v8::Name> name, const v8::PropertyCallbackInfo<v8::Integer>& info) {
+		Engine* engine = (Engine*)info.GetIsolate()->GetData(0);
+		ViewSource* source = unwrap(info.Holder());
+		if (source == nullptr || name->IsSymbol()) return;
+
+		if (source->keyed() && !inPrototype(engine, info.Holder(), name) && source->has(engine, name)) {
+			info.GetReturnValue().Set(v8::ReadOnly | v8::DontDelete);
+			return;
+		}
+		if (name->StrictEquals(support(engine)->lengthKey.Get(engine->isolate()))) {
+			info.GetReturnValue().Set(v8::ReadOnly | v8::DontDelete | v8::DontEnum);
+		}
+	}
+
+	// ************************************************************************************
+	void ViewObject::NamedDeleter(v8::Local<v8::Name> name, const v8::PropertyCallbackInfo<v8::Boolean>& info) {
+		info.GetReturnValue().Set(false);
+	}
+
+	// ************************************************************************************
+	void ViewObject::NamedEnumerator(const v8::PropertyCallbackInfo<v8::Array>& info) {
+		Engine* engine = (Engine*)info.GetIsolate()->GetData(0);
+		ViewSource* source = unwrap(info.Holder());
+		if (source == nullptr || !source->keyed()) return;
+
+		info.GetReturnValue().Set(source->keys(engine));
+	}
+
+} }
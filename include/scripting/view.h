@@ -0,0 +1,269 @@
+/*
+ * Copyright (c) preg-v8-binder <https://github.com/pregusia/preg-v8-binder>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef INCLUDE_SCRIPTING_VIEW_H_
+#define INCLUDE_SCRIPTING_VIEW_H_
+
+#include "base.h"
+#include <v8.h>
+#include <iterator>
+
+namespace scripting {
+
+	class Engine;
+
+	namespace internal {
+
+		template<typename C>
+		class ViewStorage : public stdext::object {
+			public:
+				C container;
+				ViewStorage(C&& c) : container(std::move(c)) { }
+		};
+
+	}
+
+	// Return type for lazy access to native container from scripts.
+	// JS gets object with indexed/named interceptors, elements are converted on demand.
+	// Container is kept alive by owner reference (or owned by the view itself when moved in).
+	// Sequences without random access keep iterator of last accessed element, so such container
+	// must not have elements erased while its view is used from scripts.
+	template<typename C>
+	class view {
+		public:
+			view() : m_container(nullptr) { }
+			view(C&& container) {
+				internal::ViewStorage<C>* storage = new internal::ViewStorage<C>(std::move(container));
+				m_container = &storage->container;
+				m_owner = storage;
+			}
+			view(const C& container, const stdext::object_ptr<stdext::object>& owner) : m_container(&container), m_owner(owner) { }
+
+			const C* container() const { return m_container; }
+			const stdext::object_ptr<stdext::object>& owner() const { return m_owner; }
+			bool empty() const { return m_container == nullptr; }
+
+		private:
+			const C* m_container;
+			stdext::object_ptr<stdext::object> m_owner;
+	};
+
+	namespace internal {
+
+		class ViewSource {
+			public:
+				v8::Persistent<v8::Object> handle;
+
+				virtual ~ViewSource() { handle.Reset(); }
+
+				virtual bool keyed() const = 0;
+				virtual uint32_t length() const = 0;
+				virtual v8::Local<v8::Array> keys(Engine* engine) = 0;
+
+				// sequences
+				virtual v8::Local<v8::Value> getIndex(Engine* engine, uint32_t index) { return v8::Local<v8::Value>(); }
+
+				// keyed containers, empty handle when not found
+				virtual bool has(Engine* engine, v8::Local<v8::Value> key) { return false; }
+				virtual v8::Local<v8::Value> get(Engine* engine, v8::Local<v8::Value> key) { return v8::Local<v8::Value>(); }
+		};
+
+		class ViewSupport {
+			public:
+				v8::Persistent<v8::ObjectTemplate> tpl;
+				v8::Persistent<v8::String> lengthKey;
+				v8::Persistent<v8::Value> arrayIterator;
+
+				~ViewSupport() {
+					tpl.Reset();
+					lengthKey.Reset();
+					arrayIterator.Reset();
+				}
+		};
+
+		class ViewObject {
+			public:
+				static v8::Local<v8::Object> create(Engine* engine, ViewSource* source);
+
+			private:
+				static ViewSupport* support(Engine* engine);
+				static ViewSource* unwrap(v8::Local<v8::Object> holder);
+				static bool inPrototype(Engine* engine, v8::Local<v8::Object> holder, v8::Local<v8::Name> name);
+				static void freeCallback(const v8::WeakCallbackInfo<ViewSource>& info);
+
+				static void IndexedGetter(uint32_t index, const v8::PropertyCallbackInfo<v8::Value>& info);
+				static void IndexedSetter(uint32_t index, v8::Local<v8::Value> value, const v8::PropertyCallbackInfo<v8::Value>& info);
+				static void IndexedQuery(uint32_t index, const v8::PropertyCallbackInfo<v8::Integer>& info);
+				static void IndexedDeleter(uint32_t index, const v8::PropertyCallbackInfo<v8::Boolean>& info);
+				static void IndexedEnumerator(const v8::PropertyCallbackInfo<v8::Array>& info);
+
+				static void NamedGetter(v8::Local<v8::Name> name, const v8::PropertyCallbackInfo<v8::Value>& info);
+				static void NamedSetter(v8::Local<v8::Name> name, v8::Local<v8::Value> value, const v8::PropertyCallbackInfo<v8::Value>& info);
+				static void NamedQuery(v8::Local<v8::Name> name, const v8::PropertyCallbackInfo<v8::Integer>& info);
+				static void NamedDeleter(v8::Local<v8::Name> name, const v8::PropertyCallbackInfo<v8::Boolean>& info);
+				static void NamedEnumerator(const v8::PropertyCallbackInfo<v8::Array>& info);
+		};
+
+	}
+
+} /* namespace scripting */
+
+#include "engine.h"
+
+namespace scripting { namespace internal {
+
+	template<typename C>
+	class SequenceViewSource : public ViewSource {
+		public:
+			typedef typename C::const_iterator Iterator;
+			typedef typename std::iterator_traits<Iterator>::iterator_category Category;
+
+			SequenceViewSource(const view<C>& v) : m_view(v), m_cursorIndex(0), m_cursorSize(0), m_cursorValid(false) { }
+
+			virtual bool keyed() const { return false; }
+			virtual uint32_t length() const { return (uint32_t)m_view.container()->size(); }
+
+			virtual v8::Local<v8::Value> getIndex(Engine* engine, uint32_t index) {
+				const C& c = *m_view.container();
+				if (index >= c.size()) return v8::Local<v8::Value>();
+				return converters::convertTo(engine, *at(c, index, Category()));
+			}
+
+			virtual v8::Local<v8::Array> keys(Engine* engine) {
+				uint32_t n = length();
+				std::vector<v8::Local<v8::Value>> values;
+				values.reserve(n);
+				for(uint32_t i=0;i<n;++i) values.push_back(v8::Integer::NewFromUnsigned(engine->isolate(), i));
+				return engine->newArray(values.data(), values.size());
+			}
+
+		private:
+			view<C> m_view;
+
+			// last position for containers without random access, so sequential access from
+			// scripts (for loops, iterator) is O(1) per element; dropped when size changes
+			Iterator m_cursor;
+			std::size_t m_cursorIndex;
+			std::size_t m_cursorSize;
+			bool m_cursorValid;
+
+			Iterator at(const C& c, std::size_t index, std::random_access_iterator_tag) {
+				return c.begin() + index;
+			}
+
+			Iterator at(const C& c, std::size_t index, std::forward_iterator_tag) {
+				if (!m_cursorValid || m_cursorSize != c.size() || index < m_cursorIndex) {
+					m_cursor = c.begin();
+					m_cursorIndex = 0;
+					m_cursorSize = c.size();
+					m_cursorValid = true;
+				}
+				m_cursor = std::next(m_cursor, index - m_cursorIndex);
+				m_cursorIndex = index;
+				return m_cursor;
+			}
+
+			Iterator at(const C& c, std::size_t index, std::bidirectional_iterator_tag) {
+				if (m_cursorValid && m_cursorSize == c.size() && index < m_cursorIndex && m_cursorIndex - index <= index) {
+					m_cursor = std::prev(m_cursor, m_cursorIndex - index);
+					m_cursorIndex = index;
+					return m_cursor;
+				}
+				return at(c, index, std::forward_iterator_tag());
+			}
+	};
+
+	template<typename C>
+	class KeyedViewSource : public ViewSource {
+		public:
+			typedef typename C::key_type K;
+
+			KeyedViewSource(const view<C>& v) : m_view(v) { }
+
+			virtual bool keyed() const { return true; }
+			virtual uint32_t length() const { return (uint32_t)m_view.container()->size(); }
+
+			virtual bool has(Engine* engine, v8::Local<v8::Value> key) {
+				return find(engine, key) != m_view.container()->end();
+			}
+
+			virtual v8::Local<v8::Value> get(Engine* engine, v8::Local<v8::Value> key) {
+				auto it = find(engine, key);
+				if (it == m_view.container()->end()) return v8::Local<v8::Value>();
+				return converters::convertTo(engine, it->second);
+			}
+
+			virtual v8::Local<v8::Array> keys(Engine* engine) {
+				const C& c = *m_view.container();
+				std::vector<v8::Local<v8::Value>> values;
+				values.reserve(c.size());
+				for(auto it=c.begin();it != c.end();++it) values.push_back(converters::convertTo(engine, it->first));
+				return engine->newArray(values.data(), values.size());
+			}
+
+		private:
+			view<C> m_view;
+
+			// name is a key only when it survives round trip through K, otherwise
+			// "length" or "toString" would become key 0 of int keyed map
+			typename C::const_iterator find(Engine* engine, v8::Local<v8::Value> name) {
+				const C& c = *m_view.container();
+				v8::Local<v8::Context> context = engine->isolate()->GetCurrentContext();
+				K key = converters::ConverterHelper<K>::from(engine, name);
+
+				v8::Local<v8::String> nameStr, keyStr;
+				if (!name->ToString(context).ToLocal(&nameStr)) return c.end();
+				if (!converters::convertTo(engine, key)->ToString(context).ToLocal(&keyStr)) return c.end();
+				if (!nameStr->StrictEquals(keyStr)) return c.end();
+				return c.find(key);
+			}
+	};
+
+	template<typename C>
+	struct is_keyed_container {
+		template<typename T>
+		static std::true_type test(typename T::mapped_type*);
+
+		template<typename T>
+		static std::false_type test(...);
+
+		static const bool value = std::is_same<std::true_type, decltype(test<C>(nullptr))>::value;
+	};
+
+} }
+
+namespace scripting { namespace converters {
+
+	template<typename C>
+	v8::Local<v8::Value> convertTo(Engine* engine, const view<C>& v) {
+		if (v.empty()) return engine->newNull();
+
+		typedef typename std::conditional<internal::is_keyed_container<C>::value, internal::KeyedViewSource<C>, internal::SequenceViewSource<C>>::type SourceType;
+		v8::Local<v8::Object> obj = internal::ViewObject::create(engine, new SourceType(v));
+		if (obj.IsEmpty()) return engine->newNull();
+		return obj;
+	}
+
+} }
+
+#endif /* INCLUDE_SCRIPTING_VIEW_H_ */
@@ -32,11 +32,13 @@ namespace stdext {
 		static uint64_t counter = 100;
 		m_objectRefs = 0;
 		m_objectId = counter++;
+		m_weakControl = nullptr;
 	}
 
 	// ************************************************************************************
 	object::~object() {
 		assert(m_objectRefs == 0);
+		__weakExpire();
 	}
 
 }
@@ -39,6 +39,19 @@ namespace stdext {
 	template<class T>
 	class object_ptr;
 
+	class object;
+
+	// shared by object and its weak references, allocated on first weak reference
+	struct weak_control {
+		object* obj;
+		int32_t refs;
+
+		static void release(weak_control* ctrl) {
+			ctrl->refs -= 1;
+			if (ctrl->refs == 0) delete ctrl;
+		}
+	};
+
 	class object {
 		public:
 			object();
@@ -56,15 +69,38 @@ namespace stdext {
 			virtual void __refsDec() {
 				assert(m_objectRefs > 0);
 				m_objectRefs -= 1;
-				if (m_objectRefs == 0) delete this;
+				if (m_objectRefs == 0) {
+					// expired before destructors run, so lock() cannot resurrect object
+					__weakExpire();
+					delete this;
+				}
 			}
 			virtual void __refsInc() {
 				m_objectRefs += 1;
 			}
 
+			weak_control* __weakControl() {
+				if (m_weakControl == nullptr) {
+					m_weakControl = new weak_control();
+					m_weakControl->obj = this;
+					m_weakControl->refs = 1;
+				}
+				return m_weakControl;
+			}
+
+			// weak references become expired, object itself stays alive
+			void __weakExpire() {
+				if (m_weakControl != nullptr) {
+					m_weakControl->obj = nullptr;
+					weak_control::release(m_weakControl);
+					m_weakControl = nullptr;
+				}
+			}
+
 		private:
 			volatile int32_t m_objectRefs;
 			uint64_t m_objectId;
+			weak_control* m_weakControl;
 
 			object(const object& from);
 			object& operator=(const object& from);
@@ -135,6 +171,48 @@ namespace stdext {
 			T* px;
 	};
 
+	// non-owning reference, becomes expired when object is destroyed
+	template<class T>
+	class weak_object_ptr {
+		public:
+			typedef T element_type;
+
+			weak_object_ptr() : px(nullptr), ctrl(nullptr) { }
+			weak_object_ptr(T* p) : px(p), ctrl(nullptr) {
+				static_assert(std::is_base_of<object, T>::value, "classes using stdext::weak_object_ptr must be a derived of stdext::object");
+				if (px != nullptr) {
+					ctrl = dynamic_cast<object*>(px)->__weakControl();
+					ctrl->refs += 1;
+				}
+			}
+			weak_object_ptr(const object_ptr<T>& p) : weak_object_ptr(p.get()) { }
+			weak_object_ptr(const weak_object_ptr& rhs) : px(rhs.px), ctrl(rhs.ctrl) { if (ctrl != nullptr) ctrl->refs += 1; }
+			weak_object_ptr(weak_object_ptr&& rhs) noexcept : px(rhs.px), ctrl(rhs.ctrl) {
+				rhs.px = nullptr;
+				rhs.ctrl = nullptr;
+			}
+
+			~weak_object_ptr() { if (ctrl != nullptr) weak_control::release(ctrl); }
+
+			weak_object_ptr& operator=(const weak_object_ptr& rhs) { weak_object_ptr(rhs).swap(*this); return *this; }
+			weak_object_ptr& operator=(weak_object_ptr&& rhs) { weak_object_ptr(static_cast<weak_object_ptr&&>(rhs)).swap(*this); return *this; }
+			weak_object_ptr& operator=(T* rhs) { weak_object_ptr(rhs).swap(*this); return *this; }
+			weak_object_ptr& operator=(const object_ptr<T>& rhs) { weak_object_ptr(rhs).swap(*this); return *this; }
+
+			void reset() { weak_object_ptr().swap(*this); }
+			void swap(weak_object_ptr& rhs) {
+				std::swap(px, rhs.px);
+				std::swap(ctrl, rhs.ctrl);
+			}
+
+			bool expired() const { return ctrl == nullptr || ctrl->obj == nullptr; }
+			object_ptr<T> lock() const { return expired() ? object_ptr<T>() : object_ptr<T>(px); }
+
+		private:
+			T* px;
+			weak_control* ctrl;
+	};
+
 	template<class T, class U> bool operator==(object_ptr<T> const& a, object_ptr<U> const& b) { return a.get() == b.get(); }
 	template<class T, class U> bool operator!=(object_ptr<T> const& a, object_ptr<U> const& b) { return a.get() != b.get(); }
 	template<class T, class U> bool operator==(object_ptr<T> const& a, U* b) { return a.get() == b; }
@@ -0,0 +1,258 @@
+/*
+ * Copyright (c) 2010-2015 OTClient <https://github.com/edubart/otclient>
+ * Modded by pregusia
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+
+#include "stdext.h"
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+
+namespace stdext {
+
+	namespace {
+
+		const std::size_t POOL_GRANULARITY = 16;
+		const std::size_t POOL_MAX_SIZE = 512;
+		const std::size_t POOL_CLASSES = POOL_MAX_SIZE / POOL_GRANULARITY;
+		const std::size_t POOL_CHUNK_SIZE = 64 * 1024;
+		const std::size_t THREAD_CACHE_BATCH = 16;
+		const std::size_t THREAD_CACHE_LIMIT = 64;
+
+		struct free_block {
+			free_block* next;
+		};
+
+		struct size_class {
+			std::mutex mutex;
+			free_block* free;
+
+			size_class() : free(nullptr) { }
+		};
+
+		// per thread counters are written only by owning thread (no shared cache line, no locked
+		// instructions), atomic just so pool_get_stats can read them
+		struct pool_counters {
+			std::atomic<uint64_t> allocations;
+			std::atomic<uint64_t> deallocations;
+			std::atomic<uint64_t> largeAllocations;
+
+			pool_counters() : allocations(0), deallocations(0), largeAllocations(0) { }
+		};
+
+		struct pool_state {
+			size_class classes[POOL_CLASSES];
+			std::atomic<std::size_t> reservedBytes;
+			std::atomic<bool> threadCache;
+
+			std::mutex threadsMutex;
+			std::vector<pool_counters*> threads;
+			pool_counters retired;			// exited threads, and exiting ones after their cache is gone
+
+			pool_state() : reservedBytes(0), threadCache(true) { }
+		};
+
+		// never destroyed - blocks may be released by static destructors and exiting threads
+		pool_state& state() {
+			static pool_state* s = new pool_state();
+			return *s;
+		}
+
+		// takes up to count blocks of class idx from global list, carving new chunk when empty
+		free_block* take_blocks(std::size_t idx, std::size_t count) {
+			size_class& cls = state().classes[idx];
+			std::lock_guard<std::mutex> lock(cls.mutex);
+
+			if (cls.free == nullptr) {
+				std::size_t blockSize = (idx + 1) * POOL_GRANULARITY;
+				char* chunk = static_cast<char*>(::operator new(POOL_CHUNK_SIZE));
+				state().reservedBytes.fetch_add(POOL_CHUNK_SIZE, std::memory_order_relaxed);
+
+				for(std::size_t off = 0; off + blockSize <= POOL_CHUNK_SIZE; off += blockSize) {
+					free_block* b = reinterpret_cast<free_block*>(chunk + off);
+					b->next = cls.free;
+					cls.free = b;
+				}
+			}
+
+			free_block* head = cls.free;
+			free_block* tail = head;
+			for(std::size_t i=1;i<count && tail->next != nullptr;++i) tail = tail->next;
+			cls.free = tail->next;
+			tail->next = nullptr;
+			return head;
+		}
+
+		void give_blocks(std::size_t idx, free_block* head, free_block* tail) {
+			size_class& cls = state().classes[idx];
+			std::lock_guard<std::mutex> lock(cls.mutex);
+			tail->next = cls.free;
+			cls.free = head;
+		}
+
+		// false after thread_cache of exiting thread was destroyed, blocks then go straight to global lists
+		thread_local bool t_cacheAlive = true;
+
+		struct thread_cache {
+			free_block* free[POOL_CLASSES];
+			std::size_t count[POOL_CLASSES];
+			pool_counters counters;
+
+			thread_cache() {
+				for(std::size_t i=0;i<POOL_CLASSES;++i) {
+					free[i] = nullptr;
+					count[i] = 0;
+				}
+
+				pool_state& s = state();
+				std::lock_guard<std::mutex> lock(s.threadsMutex);
+				s.threads.push_back(&counters);
+			}
+
+			~thread_cache() {
+				t_cacheAlive = false;
+				if (true) {
+					pool_state& s = state();
+					std::lock_guard<std::mutex> lock(s.threadsMutex);
+					s.threads.erase(std::find(s.threads.begin(), s.threads.end(), &counters));
+					s.retired.allocations.fetch_add(counters.allocations.load(std::memory_order_relaxed), std::memory_order_relaxed);
+					s.retired.deallocations.fetch_add(counters.deallocations.load(std::memory_order_relaxed), std::memory_order_relaxed);
+					s.retired.largeAllocations.fetch_add(counters.largeAllocations.load(std::memory_order_relaxed), std::memory_order_relaxed);
+				}
+
+				for(std::size_t i=0;i<POOL_CLASSES;++i) {
+					if (free[i] == nullptr) continue;
+					free_block* tail = free[i];
+					while (tail->next != nullptr) tail = tail->next;
+					give_blocks(i, free[i], tail);
+				}
+			}
+		};
+
+		thread_local thread_cache t_cache;
+
+		void count(std::atomic<uint64_t> pool_counters::*field) {
+			if (t_cacheAlive) {
+				std::atomic<uint64_t>& c = t_cache.counters.*field;
+				c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			} else {
+				(state().retired.*field).fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+	}
+
+	// ************************************************************************************
+	void* pool_allocate(std::size_t size) {
+		pool_state& s = state();
+		if (size == 0) size = 1;
+		if (size > POOL_MAX_SIZE) {
+			count(&pool_counters::largeAllocations);
+			return ::operator new(size);
+		}
+
+		std::size_t idx = (size - 1) / POOL_GRANULARITY;
+		count(&pool_counters::allocations);
+
+		if (s.threadCache.load(std::memory_order_relaxed) && t_cacheAlive) {
+			thread_cache& c = t_cache;
+			if (c.free[idx] == nullptr) {
+				c.free[idx] = take_blocks(idx, THREAD_CACHE_BATCH);
+				c.count[idx] = 0;
+				for(free_block* b = c.free[idx]; b != nullptr; b = b->next) c.count[idx] += 1;
+			}
+
+			free_block* b = c.free[idx];
+			c.free[idx] = b->next;
+			c.count[idx] -= 1;
+			return b;
+		}
+
+		return take_blocks(idx, 1);
+	}
+
+	// ************************************************************************************
+	void pool_deallocate(void* p, std::size_t size) {
+		if (p == nullptr) return;
+
+		pool_state& s = state();
+		if (size == 0) size = 1;
+		if (size > POOL_MAX_SIZE) {
+			::operator delete(p);
+			return;
+		}
+
+		std::size_t idx = (size - 1) / POOL_GRANULARITY;
+		count(&pool_counters::deallocations);
+		free_block* b = static_cast<free_block*>(p);
+
+		if (s.threadCache.load(std::memory_order_relaxed) && t_cacheAlive) {
+			thread_cache& c = t_cache;
+			b->next = c.free[idx];
+			c.free[idx] = b;
+			c.count[idx] += 1;
+
+			// keeps batch in cache, rest goes back for other threads
+			if (c.count[idx] > THREAD_CACHE_LIMIT) {
+				free_block* keep = c.free[idx];
+				for(std::size_t i=1;i<THREAD_CACHE_BATCH;++i) keep = keep->next;
+				free_block* head = keep->next;
+				free_block* tail = head;
+				while (tail->next != nullptr) tail = tail->next;
+				keep->next = nullptr;
+				c.count[idx] = THREAD_CACHE_BATCH;
+				give_blocks(idx, head, tail);
+			}
+			return;
+		}
+
+		b->next = nullptr;
+		give_blocks(idx, b, b);
+	}
+
+	// ************************************************************************************
+	void pool_set_thread_cache(bool enabled) {
+		state().threadCache.store(enabled);
+	}
+
+	// ************************************************************************************
+	pool_stats pool_get_stats() {
+		pool_state& s = state();
+		pool_stats res;
+		res.reservedBytes = s.reservedBytes.load(std::memory_order_relaxed);
+
+		std::lock_guard<std::mutex> lock(s.threadsMutex);
+		res.allocations = s.retired.allocations.load(std::memory_order_relaxed);
+		res.deallocations = s.retired.deallocations.load(std::memory_order_relaxed);
+		res.largeAllocations = s.retired.largeAllocations.load(std::memory_order_relaxed);
+		for(auto counters: s.threads) {
+			res.allocations += counters->allocations.load(std::memory_order_relaxed);
+			res.deallocations += counters->deallocations.load(std::memory_order_relaxed);
+			res.largeAllocations += counters->largeAllocations.load(std::memory_order_relaxed);
+		}
+		return res;
+	}
+
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2010-2015 OTClient <https://github.com/edubart/otclient>
+ * Modded by pregusia
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+
+#ifndef STDEXT_POOL_H
+#define STDEXT_POOL_H
+
+#include "types.h"
+#include <cstddef>
+#include <new>
+#include <utility>
+
+namespace stdext {
+
+	struct pool_stats {
+		uint64_t allocations;			// served from size classes
+		uint64_t deallocations;
+		uint64_t largeAllocations;		// bigger than largest size class, passed to global operator new
+		std::size_t reservedBytes;		// chunks taken from system, never returned
+
+		pool_stats() : allocations(0), deallocations(0), largeAllocations(0), reservedBytes(0) { }
+	};
+
+	// size-class allocator (16 byte steps up to 512 bytes), blocks are kept in per-class
+	// free lists; with thread cache each thread keeps few blocks per class without locking
+	void* pool_allocate(std::size_t size);
+	void pool_deallocate(void* p, std::size_t size);
+
+	void pool_set_thread_cache(bool enabled);
+	pool_stats pool_get_stats();
+
+	// size passed to pool_deallocate must be the one used for allocation, so T must be exact type
+	template<class T, class... Args>
+	T* pool_new(Args&&... args) {
+		void* p = pool_allocate(sizeof(T));
+		try {
+			return new (p) T(std::forward<Args>(args)...);
+		} catch (...) {
+			pool_deallocate(p, sizeof(T));
+			throw;
+		}
+	}
+
+	template<class T>
+	void pool_delete(T* p) {
+		if (p == nullptr) return;
+		p->~T();
+		pool_deallocate(p, sizeof(T));
+	}
+
+	// mixin - class deriving from it (and its subclasses) is allocated by pool_allocate,
+	// deleting through virtual destructor (object::__refsDec) passes size of dynamic type back
+	class pooled_object {
+		public:
+			static void* operator new(std::size_t size) { return pool_allocate(size); }
+			static void operator delete(void* p, std::size_t size) { pool_deallocate(p, size); }
+
+			static void* operator new(std::size_t size, void* where) { return where; }
+			static void operator delete(void* p, void* where) { }
+	};
+
+}
+
+#endif
@@ -34,6 +34,7 @@
 #include "format.h"
 #include "string.h"
 #include "objects.h"
+#include "pool.h"
 #include "time.h"
 
 #endif
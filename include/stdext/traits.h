@@ -27,6 +27,7 @@
 #define STDEXT_TRAITS_H
 
 #include <type_traits>
+#include <cstddef>
 
 namespace stdext {
 
@@ -35,6 +36,14 @@ namespace stdext {
 	template<class T, unsigned long N> struct replace_extent<T[N]> { typedef const T* type;};
 	template<typename T> struct remove_const_ref { typedef typename std::remove_const<typename std::remove_reference<T>::type>::type type; };
 
+	// std::index_sequence replacement (C++11)
+	template<std::size_t... I> struct index_sequence { };
+
+	template<std::size_t N, std::size_t... I> struct make_index_sequence_impl : make_index_sequence_impl<N - 1, N - 1, I...> { };
+	template<std::size_t... I> struct make_index_sequence_impl<0, I...> { typedef index_sequence<I...> type; };
+
+	template<std::size_t N> using make_index_sequence = typename make_index_sequence_impl<N>::type;
+
 };
 
 #endif